@@ -2,9 +2,14 @@
 #define NITRO_APPLICATION_HPP
 
 #include "Canvas.hpp"
+#include "CoordinateMap.hpp"
+#include "CoverageSweep.hpp"
 #include "JsonHandler.hpp"
+#include "OutputWriter.hpp"
 #include "Rectangle.hpp"
 #include "RectangleIntersection.hpp"
+#include "TiledIntersector.hpp"
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -24,7 +29,19 @@ class Application {
 			TooManyArguments, 
 			MissingPathArg, 
 			InvalidSizeArg, 
-			InvalidFile 
+			InvalidFile,
+			UnknownOption,
+			MissingOptionValue,
+			InvalidOptionValue,
+			IncompatibleOptions
+		};
+
+		// What is printed after the input rectangles
+		enum class OutputMode {
+			Intersections,
+			Counts,
+			Coverage,
+			Statistics
 		};
 
 		/* Constructor and Destructor*/
@@ -39,19 +56,34 @@ class Application {
 		bool init(int argc, char **argv);
 		ErrorCode checkArgCount(int argc) const;
 		ErrorCode parseMaxRects(const char *arg);
+		ErrorCode parseOption(int argc, char **argv, int &index);
 		ErrorCode parseFile(const std::string &path);
-		std::vector<Rectangle> loadRectangles(const size_t maxRectangles) const;
+		// Rectangles beyond the 32 bit range are loaded as ranks of coordinates, which are then kept
+		std::vector<Rectangle> loadRectangles(const size_t maxRectangles);
 
-		void printOutput(const std::vector<Rectangle> &rectangles,
-		                 const std::vector<Canvas::RectangleIntersection> &intersections) const;
+		void printOutput(OutputWriter &out, const std::vector<Rectangle> &rectangles, const Canvas &canvas) const;
+		void printCounts(OutputWriter &out, const std::vector<Rectangle> &rectangles, const Canvas &canvas) const;
+		void printCoverage(OutputWriter &out, const std::vector<Rectangle> &rectangles, const Canvas &canvas) const;
+		void printStatistics(OutputWriter &out, const std::vector<Rectangle> &rectangles, const Canvas &canvas) const;
+		void printTiledOutput(OutputWriter &out) const;
+		bool printInput(OutputWriter &out, const std::vector<Rectangle> &rectangles) const;
 		void printHelp();
 		void reportError(ErrorCode errorCode) const;
+		void reportLimit(Canvas::LimitReached limitReached) const;
 
 		/* Member variables */
 		bool initialized;
 		JsonHandler jsonHandler;
 		Canvas canvas;
 		size_t maxRectangles;
+		size_t threadCount;
+		Canvas::Limits limits;
+		OutputMode outputMode;
+		// Rectangles per tile when the input is processed out of core, 0 loads it as a whole
+		size_t rectanglesPerTile;
+		std::string inputPath;
+		// Set when the loaded rectangles are ranks of their coordinates, see CoordinateMap
+		std::optional<CoordinateMap> coordinates;
 
 		/* For Testing */
 #ifdef TEST
@@ -70,6 +102,19 @@ class Application {
 		FRIEND_TEST(ApplicationTest, LoadRectanglesStopsAtMaxRectCount);
 		FRIEND_TEST(ApplicationTest, LoadRectanglesDefaultMaxRectCount);
 		FRIEND_TEST(ApplicationTest, LoadRectanglesOverridesDefault);
+		FRIEND_TEST(ApplicationTest, ThreadsOption);
+		FRIEND_TEST(ApplicationTest, ThreadsOptionMissingValue);
+		FRIEND_TEST(ApplicationTest, ThreadsOptionInvalidValue);
+		FRIEND_TEST(ApplicationTest, UnknownOption);
+		FRIEND_TEST(ApplicationTest, LimitOptions);
+		FRIEND_TEST(ApplicationTest, MemoryBudgetSuffixes);
+		FRIEND_TEST(ApplicationTest, MaxOrderMustAllowPairs);
+		FRIEND_TEST(ApplicationTest, CountOnlyOption);
+		FRIEND_TEST(ApplicationTest, CoverageOption);
+		FRIEND_TEST(ApplicationTest, StatisticsOption);
+		FRIEND_TEST(ApplicationTest, TiledOption);
+		FRIEND_TEST(ApplicationTest, TiledOptionOnlyListsIntersections);
+		FRIEND_TEST(ApplicationTest, HugeCoordinatesAreMapped);
 #endif
 };
 
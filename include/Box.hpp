@@ -0,0 +1,40 @@
+#ifndef NITRO_BOX_HPP
+#define NITRO_BOX_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+namespace nitro {
+
+/* BasicBox is the packed form of a rectangle's extent, as its four edges, used for internal computation.
+   A box carries no invariants of its own: left <= right and top <= bottom are guaranteed by whoever builds it.
+   The canvas works on 32 bit boxes; narrower coordinate types are used where a known range allows it, and 64 bit
+   boxes hold input beyond that range until it is mapped to ranks by CoordinateMap. */
+template <typename Coordinate> struct BasicBox {
+		Coordinate left;
+		Coordinate top;
+		Coordinate right;
+		Coordinate bottom;
+
+		bool operator==(const BasicBox &other) const = default;
+
+		// Overlapping region of two boxes, only meaningful when the result hasArea()
+		static BasicBox clip(const BasicBox &a, const BasicBox &b) {
+			return {std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right),
+			        std::min(a.bottom, b.bottom)};
+		}
+
+		// Whether the box has a positive area, which is what makes an intersection
+		bool hasArea() const {
+			return left < right && top < bottom;
+		}
+};
+
+using Box = BasicBox<int32_t>;
+using WideBox = BasicBox<int64_t>;
+
+static_assert(sizeof(Box) == 16, "Box must stay packed");
+static_assert(sizeof(BasicBox<uint16_t>) == 8, "16 bit boxes must stay packed");
+
+} // namespace nitro
+#endif // NITRO_BOX_HPP
@@ -1,7 +1,16 @@
 #ifndef NITRO_CANVAS_HPP
 #define NITRO_CANVAS_HPP
 
+#include "CoverageSweep.hpp"
+#include "DynamicGrid.hpp"
+#include "PartitionJoin.hpp"
 #include "Rectangle.hpp"
+#include "RTree.hpp"
+#include "RectangleStore.hpp"
+#include "ThreadPool.hpp"
+#include "UniformGrid.hpp"
+#include <functional>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
@@ -18,6 +27,105 @@ class Canvas {
 		/* Nested Classes */
 		class RectangleIntersection;
 
+		/* Defines */
+		// Algorithm used to determine 2nd-order intersections.
+		// BruteForce tests every pair of rectangles and is kept as the reference implementation.
+		// SweepLine runs on the canvas thread pool when more than one thread is configured.
+		// Higher-order intersections are always expanded on the thread pool, one level at a time.
+		enum class PairwiseEngine {
+			BruteForce,
+			SweepLine,
+			Grid,
+			RTree
+		};
+
+		// Algorithm used to grow 2nd-order intersections into higher-order intersections.
+		// Exhaustive tries every rectangle against every intersection and is kept as the reference implementation.
+		// NeighborRestricted only extends an intersection with rectangles that overlap all of its members and
+		// have a larger ID, so every combination is generated exactly once.
+		enum class EnumerationStrategy {
+			Exhaustive,
+			NeighborRestricted
+		};
+
+		// Caps on the enumeration of intersections, so that inputs with deeply nested rectangles can't exhaust the
+		// machine. 0 disables a limit.
+		struct Limits {
+				// Largest number of rectangles in an intersection, at least 2
+				size_t maxOrder{0};
+				// Number of intersections returned
+				size_t maxResults{0};
+				// Approximate number of bytes held by the enumeration. intersectAll() holds every intersection it
+				// returns, streamIntersections() the pairwise ones, the overlap graph and the levels being expanded.
+				size_t memoryBudget{0};
+		};
+
+		// Limit that stopped an enumeration early. Intersections found up to that point are still returned.
+		enum class LimitReached {
+			None,
+			MaxOrder,
+			MaxResults,
+			MemoryBudget
+		};
+
+		// Memory use of one level of the enumeration. The candidates of a given order, their extension lists and
+		// their spilled IDs live in arenas; what intersectAll() keeps of them is copied out to the heap.
+		struct LevelAllocations {
+				size_t order{0};
+				// Requests served by the arenas, each of which used to be a heap allocation
+				uint64_t allocations{0};
+				uint64_t bytes{0};
+				// Blocks the arenas took from the heap to serve them
+				uint64_t blocks{0};
+				// Heap allocations of the result: spilled IDs of the intersections it keeps, and its own growth
+				uint64_t heapAllocations{0};
+				uint64_t heapBytes{0};
+		};
+
+		// Hash tables that recognize combinations of rectangles already found by the exhaustive enumeration,
+		// summed over their shards
+		struct IdSetStatistics {
+				size_t entries{0};
+				size_t capacity{0};
+				double loadFactor{0.0};
+				// Probe counters of every insert
+				uint64_t lookups{0};
+				double averageProbeLength{0.0};
+				size_t maxProbeLength{0};
+				// Inserts that met an equal fingerprint with different IDs
+				uint64_t collisions{0};
+		};
+
+		// Receives intersections one at a time from streamIntersections()
+		using IntersectionSink = std::function<void(const RectangleIntersection &)>;
+		// Same, and returns whether it wants any more of them
+		using StoppingSink = std::function<bool(const RectangleIntersection &)>;
+
+		// Number and total area of the intersections of one order, as reported by countIntersections()
+		struct OrderSummary {
+				size_t order{0};
+				uint64_t count{0};
+				uint64_t area{0};
+		};
+
+		// One query of a batch given to queryBatch(). A point query is a window without extent.
+		struct Query {
+				int left{0};
+				int top{0};
+				int right{0};
+				int bottom{0};
+
+				static Query point(int x, int y);
+				static Query window(const Rectangle &window);
+		};
+
+		// Overlap between a rectangle of this canvas (first) and one of the canvas it is joined with (second)
+		struct JoinPair {
+				Rectangle::ID first;
+				Rectangle::ID second;
+				Rectangle shape;
+		};
+
 		/* Constructors, Destructors*/
 		Canvas() = default;
 		Canvas(const std::vector<Rectangle> &input);
@@ -26,20 +134,136 @@ class Canvas {
 		/* Getters and Setters */
 		size_t getRectangleCount() const;
 		std::set<Rectangle> getRectangles() const;
+		const RectangleStore &getRectangleStore() const;
 		Rectangle getRectangleAtIndex(size_t index) const;
+		PairwiseEngine getPairwiseEngine() const;
+		void setPairwiseEngine(PairwiseEngine engine);
+		size_t getThreadCount() const;
+		void setThreadCount(size_t threadCount);
+		// Runs on a pool shared with other users, which must not call it at the same time. nullptr runs on the
+		// calling thread.
+		void setThreadPool(std::shared_ptr<ThreadPool> threadPool);
+		int64_t getGridCellSize() const;
+		void setGridCellSize(int64_t cellSize);
+		EnumerationStrategy getEnumerationStrategy() const;
+		void setEnumerationStrategy(EnumerationStrategy strategy);
+		Limits getLimits() const;
+		void setLimits(const Limits &limits);
+		// Limit that stopped the last call to intersectAll()
+		LimitReached getLimitReached() const;
+		// Memory use of the last call to intersectAll(), per level. Only the neighbor restricted enumeration runs on
+		// arenas, the exhaustive one is left as the plain reference implementation.
+		const std::vector<LevelAllocations> &getLevelAllocations() const;
+		// Hash table use of the last call to intersectAll(). Only the exhaustive enumeration looks for duplicates,
+		// the neighbor restricted one leaves these at zero.
+		const IdSetStatistics &getIdSetStatistics() const;
 
 		/* Operations */
 		const std::vector<RectangleIntersection> intersectAll();
+		// Hands the intersections of intersectAll() to sink, in the same order, as soon as each level is complete.
+		// Levels are enumerated with the same strategy and thread pool, and emitted ones are not kept.
+		LimitReached streamIntersections(const IntersectionSink &sink) const;
+		// Same as streamIntersections(), until sink returns false. The enumeration then stops right away, without
+		// expanding any further level, and returns LimitReached::MaxResults.
+		LimitReached streamIntersectionsWhile(const StoppingSink &sink) const;
+		// Counts the intersections of every order, from 2 up to the deepest one or Limits::maxOrder, without
+		// building them. Memory grows with the input and the pairwise intersections, not with the output.
+		std::vector<OrderSummary> countIntersections() const;
+		// Union area, summed pairwise overlap area and covered bounding box, from one sweep over the canvas
+		CoverageSweep::Statistics computeStatistics() const;
+		// Pairs of rectangles, one from each canvas, that overlap with a positive area, ordered by ID.
+		// Same side pairs are never looked at, and both canvases may use the same IDs.
+		std::vector<JoinPair> join(const Canvas &other) const;
 		std::string toString() const;
 
+		/* Edits */
+		// Adds a rectangle and returns the intersections it takes part in, ordered like intersectAll().
+		// Only the rectangles around it are visited, through a spatial index that is built on the first edit.
+		// Edits move rectangles within the store, so store indices are only stable between edits.
+		std::vector<RectangleIntersection> insert(const Rectangle &rectangle);
+		// Removes a rectangle and returns the intersections it took part in, ordered like intersectAll()
+		std::vector<RectangleIntersection> erase(Rectangle::ID id);
+
+		/* Queries */
+		// IDs of the rectangles covering the point, edges included, in ascending order.
+		// The first query builds an R-tree over the canvas, which edits replace with their own index.
+		std::vector<Rectangle::ID> queryPoint(int x, int y);
+		// IDs of the rectangles touching the window, edges included, in ascending order
+		std::vector<Rectangle::ID> queryWindow(const Rectangle &window);
+		// Answers every query, spread over the thread pool, and returns the results in the order of the queries.
+		// Queries are run along a Z-order curve so that nearby queries share the parts of the index they touch.
+		std::vector<std::vector<Rectangle::ID>> queryBatch(const std::vector<Query> &queries);
+
 	private:
+		/* Internal Types */
+		// Called once per overlapping pair, with the store indices (in either order) and the overlapping region
+		using PairCallback = std::function<void(size_t first, size_t second, int left, int top, int right, int bottom)>;
+
+		// Progress of an enumeration of higher-order intersections, which hands them to sink level by level,
+		// in the order of intersectAll()
+		struct Enumeration {
+				StoppingSink sink;
+				// Intersections given to sink so far, pairwise ones included
+				size_t emitted{0};
+				// Bytes held outside of the levels being expanded, which the memory budget covers as well
+				size_t heldBytes{0};
+				// Whether sink keeps every intersection it receives, which then adds to heldBytes
+				bool retainsResults{false};
+				LimitReached limitReached{LimitReached::None};
+				std::vector<LevelAllocations> levelAllocations;
+				IdSetStatistics idSetStatistics;
+
+				// Hands an intersection to sink, or returns false once Limits::maxResults were given or sink asked
+				// for no more
+				bool emit(const RectangleIntersection &intersection, size_t maxResults);
+		};
+
 		/* Internal Member Functions*/
-		std::optional<std::set<RectangleIntersection>> determinePairwiseIntersections();
-		std::optional<std::set<RectangleIntersection>>
-		determineAllIntersections(const std::set<RectangleIntersection> &pairwiseIntersections);
+		void forEachPairwiseIntersection(const PairCallback &callback) const;
+		std::vector<RectangleIntersection> determineLocalIntersections(size_t index) const;
+		DynamicGrid &getDynamicIndex();
+		RectangleStore sortedStore() const;
+		void restoreOrder();
+		void buildQueryIndex();
+		std::vector<Rectangle::ID> queryIndex(int left, int top, int right, int bottom) const;
+		void forEachPairParallel(const PairCallback &callback) const;
+		std::optional<std::set<RectangleIntersection>> determinePairwiseIntersections() const;
+		std::set<RectangleIntersection> determinePairwiseIntersectionsBruteForce() const;
+		std::set<RectangleIntersection> determinePairwiseIntersectionsSweepLine() const;
+		std::set<RectangleIntersection> determinePairwiseIntersectionsParallel() const;
+		std::set<RectangleIntersection> determinePairwiseIntersectionsGrid() const;
+		std::set<RectangleIntersection> determinePairwiseIntersectionsRTree() const;
+		std::set<RectangleIntersection>
+		determineAllIntersectionsExhaustive(const std::set<RectangleIntersection> &pairwiseIntersections);
+		std::set<RectangleIntersection>
+		determineAllIntersectionsNeighborRestricted(const std::set<RectangleIntersection> &pairwiseIntersections);
+		std::vector<RectangleIntersection> collectAllIntersections(const std::set<RectangleIntersection> &pairwise,
+		                                                           EnumerationStrategy strategy);
+		// Grow the pairwise intersections of a store in ascending ID order into every higher-order intersection
+		void enumerate(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+		               EnumerationStrategy strategy, Enumeration &enumeration) const;
+		void enumerateExhaustive(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+		                         Enumeration &enumeration) const;
+		void enumerateNeighborRestricted(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+		                                 Enumeration &enumeration) const;
 
 		/* Member Variables */
-		std::set<Rectangle> rectangles;
+		RectangleStore rectangles;
+		PairwiseEngine pairwiseEngine{PairwiseEngine::SweepLine};
+		int64_t gridCellSize{UniformGrid::AUTOMATIC_CELL_SIZE};
+		// Shared by copies of the canvas; null when running on a single thread
+		std::shared_ptr<ThreadPool> threadPool;
+		EnumerationStrategy enumerationStrategy{EnumerationStrategy::NeighborRestricted};
+		Limits limits;
+		LimitReached limitReached{LimitReached::None};
+		std::vector<LevelAllocations> levelAllocations;
+		IdSetStatistics idSetStatistics;
+		// Built on the first edit, and dropped when the grid cell size changes
+		std::optional<DynamicGrid> dynamicIndex;
+		// Built on the first query, and dropped by edits
+		std::optional<RTree> queryTree;
+		// Whether the store is in ascending ID order, which edits don't maintain
+		bool ordered{true};
 
 		/* For Testing */
 #ifdef TEST
@@ -51,6 +275,13 @@ class Canvas {
 		FRIEND_TEST(CanvasTest, PairwiseIntersectionsCocentricRectangles);
 		FRIEND_TEST(CanvasTest, PairwiseIntersectionOneRectangle);
 		FRIEND_TEST(CanvasTest, PairwiseIntersectionZeroRectangles);
+		FRIEND_TEST(CanvasTest, PairwiseSweepLineMatchesBruteForce);
+		FRIEND_TEST(CanvasTest, PairwiseSweepLineTouchingEdgesDoNotIntersect);
+		FRIEND_TEST(CanvasTest, NeighborRestrictedMatchesExhaustive);
+		FRIEND_TEST(CanvasTest, PairwiseGridMatchesBruteForce);
+		FRIEND_TEST(CanvasTest, PairwiseRTreeMatchesBruteForce);
+		FRIEND_TEST(CanvasTest, PairwiseParallelMatchesSweepLine);
+		FRIEND_TEST(CanvasTest, ParallelEnumerationMatchesSerial);
 #endif
 };
 
@@ -0,0 +1,39 @@
+#ifndef NITRO_COORDINATEMAP_HPP
+#define NITRO_COORDINATEMAP_HPP
+
+#include "Box.hpp"
+#include "Rectangle.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace nitro {
+
+/* CoordinateMap lets the canvas work on input whose coordinates don't fit in 32 bits.
+   Which rectangles intersect, and which edges bound every intersection, only depends on the order of the edges along
+   each axis. Every edge is replaced by its rank among the distinct edges of its axis, the canvas runs on those ranks
+   as usual, and expand() gives the results their real coordinates back. Lengths and areas are not preserved, so
+   nothing measured on the ranks means anything for the input. */
+class CoordinateMap {
+	public:
+		/* Constructors, Destructors */
+		CoordinateMap() = default;
+		explicit CoordinateMap(const std::vector<WideBox> &boxes);
+		~CoordinateMap() = default;
+
+		/* Functions */
+		// Whether the box can be used by the canvas as it is
+		static bool fits(const WideBox &box);
+		// Rectangle made of the ranks of the edges of box, which must be one of the boxes the map was built from
+		Rectangle compress(Rectangle::ID id, const WideBox &box) const;
+		// Real edges of a box made of ranks
+		WideBox expand(const Box &box) const;
+
+	private:
+		/* Internal Members */
+		// Distinct edges of each axis in ascending order, the rank of an edge is its index
+		std::vector<int64_t> xs;
+		std::vector<int64_t> ys;
+};
+
+} // namespace nitro
+#endif // NITRO_COORDINATEMAP_HPP
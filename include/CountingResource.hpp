@@ -0,0 +1,39 @@
+#ifndef NITRO_COUNTINGRESOURCE_HPP
+#define NITRO_COUNTINGRESOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace nitro {
+
+/* CountingResource is a polymorphic memory resource that passes every request on to another resource and counts
+   the allocations and bytes that went through it. Counting is not synchronized, like the monotonic arenas it is
+   meant to sit in front of or behind. */
+class CountingResource : public std::pmr::memory_resource {
+	public:
+		/* Constructors, Destructors */
+		explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+		~CountingResource() override = default;
+		CountingResource(const CountingResource &) = delete;
+		CountingResource &operator=(const CountingResource &) = delete;
+
+		/* Getters */
+		uint64_t getAllocationCount() const;
+		uint64_t getAllocatedBytes() const;
+		std::pmr::memory_resource *getUpstream() const;
+
+	private:
+		/* Internal Functions */
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+		/* Internal Members */
+		std::pmr::memory_resource *upstream;
+		uint64_t allocationCount{0};
+		uint64_t allocatedBytes{0};
+};
+
+} // namespace nitro
+#endif // NITRO_COUNTINGRESOURCE_HPP
@@ -0,0 +1,62 @@
+#ifndef NITRO_COVERAGESWEEP_HPP
+#define NITRO_COVERAGESWEEP_HPP
+
+#include "RectangleStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace nitro {
+
+/* CoverageSweep answers how deeply the canvas is covered, without enumerating any intersection: the maximum number
+   of rectangles covering a point, the regions covered that many times and the area covered by each depth.
+   A sweep line moves along x over the rectangle edges while a segment tree over the compressed y coordinates
+   keeps the depth of every y interval, so the maximum depth and its regions take O(n log n), plus the number of
+   regions reported. Rectangles cover their interior only, like intersections, so edges and line rectangles
+   add no depth. */
+class CoverageSweep {
+	public:
+		/* Defines */
+		struct Region {
+				int left;
+				int top;
+				int right;
+				int bottom;
+		};
+
+		// Area statistics of a whole canvas. overlapArea adds up the overlap of every pair of rectangles,
+		// so a point covered d times counts d * (d - 1) / 2 times.
+		struct Statistics {
+				uint64_t unionArea{0};
+				uint64_t overlapArea{0};
+				// Bounding box of the covered area, empty when no rectangle has an area
+				std::optional<Region> boundingBox;
+		};
+
+		/* Constructors, Destructors */
+		CoverageSweep() = default;
+		explicit CoverageSweep(const RectangleStore &store);
+		~CoverageSweep() = default;
+
+		/* Getters */
+		size_t getMaxDepth() const;
+		// Disjoint regions covered by getMaxDepth() rectangles, ordered by left then top edge
+		const std::vector<Region> &getMaxDepthRegions() const;
+
+		/* Functions */
+		// Area covered by exactly d rectangles at index d, for d from 1 to getMaxDepth(); index 0 is always 0.
+		// Runs a second sweep in O(n) memory. Every slab between two edges costs O(log n) per stretch of uniform depth
+		// it crosses, so this takes O(n log n) on sparse overlaps and up to O(n^2 log n) on deeply nested ones.
+		std::vector<uint64_t> computeAreaByDepth(const RectangleStore &store) const;
+		// Single O(n log n) sweep, independent of the maximum depth
+		static Statistics computeStatistics(const RectangleStore &store);
+
+	private:
+		/* Internal Members */
+		size_t maxDepth{0};
+		std::vector<Region> maxDepthRegions;
+};
+
+} // namespace nitro
+#endif // NITRO_COVERAGESWEEP_HPP
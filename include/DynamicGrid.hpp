@@ -0,0 +1,52 @@
+#ifndef NITRO_DYNAMICGRID_HPP
+#define NITRO_DYNAMICGRID_HPP
+
+#include "RectangleStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace nitro {
+
+/* DynamicGrid is a spatial hash of square cells that rectangles can be added to and removed from one at a time.
+   Only cells holding rectangles exist, so the grid has no bounds and edits never rebuild it.
+   Rectangles are kept by ID, which stays valid while store indices move, and are looked up in the store when
+   queried. Rectangles spanning too many cells are kept in a separate list that every query checks. */
+class DynamicGrid {
+	public:
+		/* Defines */
+		// Pick the cell size from the mean rectangle extent
+		static constexpr int64_t AUTOMATIC_CELL_SIZE = 0;
+		// Cell size used when there is nothing to derive it from
+		static constexpr int64_t DEFAULT_CELL_SIZE = 64;
+		// Rectangles touching more cells than this are not binned
+		static constexpr size_t MAX_CELLS_PER_RECTANGLE = 64;
+
+		/* Constructors, Destructors */
+		explicit DynamicGrid(const RectangleStore &store, int64_t cellSize = AUTOMATIC_CELL_SIZE);
+		~DynamicGrid() = default;
+
+		/* Getters */
+		int64_t getCellSize() const;
+		size_t getCellCount() const;
+
+		/* Functions */
+		void insert(Rectangle::ID id, int left, int top, int right, int bottom);
+		void erase(Rectangle::ID id, int left, int top, int right, int bottom);
+		// Store indices of the rectangles touching the window, edges included, in ascending order
+		std::vector<size_t> queryWindow(const RectangleStore &store, int left, int top, int right, int bottom) const;
+
+	private:
+		/* Internal Functions */
+		int64_t cellOf(int coordinate) const;
+		static uint64_t keyOf(int64_t column, int64_t row);
+
+		/* Internal Members */
+		int64_t cellSize{DEFAULT_CELL_SIZE};
+		std::unordered_map<uint64_t, std::vector<Rectangle::ID>> cells;
+		std::vector<Rectangle::ID> oversized;
+};
+
+} // namespace nitro
+#endif // NITRO_DYNAMICGRID_HPP
@@ -0,0 +1,74 @@
+#ifndef NITRO_IDSETTABLE_HPP
+#define NITRO_IDSETTABLE_HPP
+
+#include "Rectangle.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace nitro {
+
+/* IdSetTable is a set of sorted rectangle ID lists, used to recognize combinations of rectangles that were
+   already found. It is an open addressing hash table with linear probing: every slot holds the 64-bit fingerprint
+   of a list and where the list lives in an arena shared by all entries, so an insert costs one copy into the arena
+   and a lookup only compares IDs when the fingerprints match.
+   The table is not thread safe. */
+class IdSetTable {
+	public:
+		/* Defines */
+		// The table grows once more than MAX_LOAD_PERCENT of its slots are in use
+		static constexpr size_t MAX_LOAD_PERCENT = 70;
+		static constexpr size_t INITIAL_CAPACITY = 64;
+
+		/* Constructors, Destructors */
+		IdSetTable() = default;
+		~IdSetTable() = default;
+
+		/* Getters */
+		size_t size() const;
+		bool empty() const;
+		size_t getCapacity() const;
+		double getLoadFactor() const;
+		// Probe counters cover every insert and lookup since the table was created or cleared
+		uint64_t getLookupCount() const;
+		double getAverageProbeLength() const;
+		size_t getMaxProbeLength() const;
+		// Lookups that met an equal fingerprint with different IDs
+		uint64_t getCollisionCount() const;
+
+		/* Functions */
+		static uint64_t fingerprint(std::span<const Rectangle::ID> ids);
+		// ids must be sorted. Returns false if the list was already in the table
+		bool insert(std::span<const Rectangle::ID> ids);
+		bool insert(std::span<const Rectangle::ID> ids, uint64_t fingerprint);
+		bool contains(std::span<const Rectangle::ID> ids) const;
+		void clear();
+
+	private:
+		/* Internal Types */
+		struct Slot {
+				uint64_t fingerprint;
+				size_t offset;
+				uint32_t count;
+				bool occupied;
+		};
+
+		/* Internal Functions */
+		// Index of the slot holding ids, or of the empty slot where they belong
+		size_t findSlot(std::span<const Rectangle::ID> ids, uint64_t fingerprint) const;
+		void grow();
+
+		/* Internal Members */
+		std::vector<Slot> slots;
+		std::vector<Rectangle::ID> arena;
+		size_t entries{0};
+
+		mutable uint64_t lookups{0};
+		mutable uint64_t probes{0};
+		mutable size_t maxProbeLength{0};
+		mutable uint64_t collisions{0};
+};
+
+} // namespace nitro
+#endif // NITRO_IDSETTABLE_HPP
@@ -0,0 +1,48 @@
+#ifndef NITRO_INTERSECTIONKERNEL_HPP
+#define NITRO_INTERSECTIONKERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nitro {
+
+/* IntersectionKernel tests one rectangle against a block of candidate rectangles at once.
+   Rectangles are given by their edges (left < right, top < bottom for rectangles with area), candidates as one
+   array per edge. With GCC and Clang on x86, the kernel is built for AVX2 and SSE4.1 next to a scalar loop, and the
+   best one the processor supports is picked at startup; the rest of the program is built for the baseline target.
+   All implementations give the same results. */
+class IntersectionKernel {
+	public:
+		/* Defines */
+		static constexpr size_t BLOCK_SIZE = 8;
+
+		// Ordered from the least to the most capable
+		enum class InstructionSet { Scalar, SSE41, AVX2 };
+
+		// Edges of up to BLOCK_SIZE rectangles, one array per edge
+		struct Block {
+				alignas(32) int lefts[BLOCK_SIZE];
+				alignas(32) int tops[BLOCK_SIZE];
+				alignas(32) int rights[BLOCK_SIZE];
+				alignas(32) int bottoms[BLOCK_SIZE];
+		};
+
+		/* Functions */
+		// Returns a mask where bit i is set when candidate i overlaps the rectangle with a positive area.
+		// The overlapping region of candidate i is written to clipped at position i; other positions are undefined.
+		// count must not exceed BLOCK_SIZE.
+		static uint32_t intersect(int left, int top, int right, int bottom, const int *lefts, const int *tops,
+		                          const int *rights, const int *bottoms, size_t count, Block &clipped);
+		static uint32_t intersectScalar(int left, int top, int right, int bottom, const int *lefts, const int *tops,
+		                                const int *rights, const int *bottoms, size_t count, Block &clipped);
+		// Runs a given implementation, which must be supported by the processor
+		static uint32_t intersectWith(InstructionSet instructionSet, int left, int top, int right, int bottom,
+		                              const int *lefts, const int *tops, const int *rights, const int *bottoms,
+		                              size_t count, Block &clipped);
+		static bool isSupported(InstructionSet instructionSet);
+		// Name of the implementation used by intersect()
+		static const char *getInstructionSet();
+};
+
+} // namespace nitro
+#endif // NITRO_INTERSECTIONKERNEL_HPP
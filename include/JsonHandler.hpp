@@ -1,7 +1,10 @@
 #ifndef NITRO_JSONHANDLER_H
 #define NITRO_JSONHANDLER_H
 
+#include "Box.hpp"
+#include "Rectangle.hpp"
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <optional>
@@ -13,6 +16,9 @@ using json = nlohmann::json;
 
 class JsonHandler { 
 	public:
+		/* Defines */
+		using RectangleVisitor = std::function<void(const Rectangle &)>;
+
 		/* Constructor, Destructor */
 		JsonHandler();
 		explicit JsonHandler(const std::string &path);
@@ -25,7 +31,16 @@ class JsonHandler {
 		bool loadFile(const std::string &filePath);
 		std::optional<json> getArray(const std::string &key, const size_t maxSize = 10) const;
 
-		template <typename T> static std::optional<T> unmarshal(json j);
+		// Implemented for Rectangle and WideBox, and vectors of either. Rectangles reject coordinates beyond 32 bits,
+		// WideBoxes accept anything whose edges fit in 64 bits.
+		template <typename T> static std::optional<T> unmarshal(const json &j);
+		// Opens the file for reading, with the same checks as loadFile()
+		static std::ifstream openFile(const std::string &filePath);
+		// Calls visit for every rectangle in the array at key, in file order and with IDs from 1, and returns how
+		// many were visited. The file is parsed as a stream and never held in memory as a whole. Stops after
+		// maxSize rectangles, and rejects the same input as getArray() followed by unmarshal().
+		static size_t streamRectangles(const std::string &filePath, const std::string &key, size_t maxSize,
+		                               const RectangleVisitor &visit);
 
 	private:
 		/* Member Variables*/
@@ -0,0 +1,79 @@
+#ifndef NITRO_OUTPUTWRITER_HPP
+#define NITRO_OUTPUTWRITER_HPP
+
+#include "Canvas.hpp"
+#include "CoordinateMap.hpp"
+#include "Rectangle.hpp"
+#include "RectangleIntersection.hpp"
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace nitro {
+
+/* OutputWriter formats text into a reusable buffer and hands it to a stream in large writes.
+   Numbers are formatted with std::to_chars, and rectangles and intersections are written in the format of their
+   toString(), without building any temporary strings. The buffer is flushed when full, by flush() and on destruction,
+   so anything written to another stream in between must be preceded by a flush().
+   When the canvas runs on ranks of a CoordinateMap, the map set with setCoordinateMap() gives rectangles and
+   intersections their real coordinates. */
+class OutputWriter {
+	public:
+		/* Defines */
+		static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+		/* Constructors, Destructors */
+		explicit OutputWriter(std::ostream &stream, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+		~OutputWriter();
+		OutputWriter(const OutputWriter &) = delete;
+		OutputWriter &operator=(const OutputWriter &) = delete;
+
+		/* Operators */
+		OutputWriter &operator<<(std::string_view text);
+		OutputWriter &operator<<(char character);
+		template <std::integral T> OutputWriter &operator<<(T value);
+		// Same text as Rectangle::toString()
+		OutputWriter &operator<<(const Rectangle &rectangle);
+		// Same text as RectangleIntersection::toString()
+		OutputWriter &operator<<(const Canvas::RectangleIntersection &intersection);
+
+		/* Getters and Setters */
+		// nullptr, the default, prints coordinates as they are. The map must outlive the writer.
+		void setCoordinateMap(const CoordinateMap *coordinates);
+
+		/* Functions */
+		void flush();
+
+	private:
+		/* Defines */
+		// Longest number to_chars can produce for 64 bit integers, sign included
+		static constexpr size_t MAX_NUMBER_LENGTH = std::numeric_limits<uint64_t>::digits10 + 2;
+
+		/* Internal Functions */
+		// Makes room for size bytes at the end of the buffer
+		void reserve(size_t size);
+		// Edges of the rectangle in the coordinates of the input
+		WideBox inputBox(const Rectangle &rectangle) const;
+
+		/* Internal Members */
+		std::ostream &stream;
+		std::vector<char> buffer;
+		size_t used{0};
+		const CoordinateMap *coordinates{nullptr};
+};
+
+/* Inline formatting of numbers: called for every number in the output */
+template <std::integral T> OutputWriter &OutputWriter::operator<<(T value) {
+	reserve(MAX_NUMBER_LENGTH);
+	char *begin = buffer.data() + used;
+	used = static_cast<size_t>(std::to_chars(begin, begin + MAX_NUMBER_LENGTH, value).ptr - buffer.data());
+	return *this;
+}
+
+} // namespace nitro
+#endif // NITRO_OUTPUTWRITER_HPP
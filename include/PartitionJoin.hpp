@@ -0,0 +1,65 @@
+#ifndef NITRO_PARTITIONJOIN_HPP
+#define NITRO_PARTITIONJOIN_HPP
+
+#include "RectangleStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nitro {
+
+/* PartitionJoin finds the overlapping pairs between two RectangleStores with a partition based spatial merge join.
+   The common extent of both stores is cut into a grid of tiles, every rectangle is listed in each tile it touches,
+   and every tile is joined on its own with a sweep over both of its lists, so tiles can run in parallel.
+   A pair sharing several tiles is only reported by the tile holding the top left corner of its overlap.
+   The join refers to rectangles by their store indices, and the same stores must be passed to every operation. */
+class PartitionJoin {
+	public:
+		/* Defines */
+		// Pick the tile count from the number of rectangles
+		static const size_t AUTOMATIC_TILE_COUNT = 0;
+		// Rectangles per tile aimed for by AUTOMATIC_TILE_COUNT
+		static const size_t RECTANGLES_PER_TILE = 256;
+
+		// Called once per overlapping pair, with the index in the first store, the index in the second store and
+		// the overlapping region
+		using PairCallback = std::function<void(size_t first, size_t second, int left, int top, int right, int bottom)>;
+
+		/* Constructors, Destructors */
+		PartitionJoin(const RectangleStore &first, const RectangleStore &second,
+		              size_t tileCount = AUTOMATIC_TILE_COUNT);
+		~PartitionJoin() = default;
+
+		/* Getters */
+		size_t getTileCount() const;
+		size_t getColumnCount() const;
+		size_t getRowCount() const;
+
+		/* Functions */
+		// Reports the pairs with a positive overlap area that belong to the tile
+		void joinTile(const RectangleStore &first, const RectangleStore &second, size_t tile,
+		              const PairCallback &callback) const;
+
+	private:
+		/* Internal Functions */
+		size_t columnOf(int64_t x) const;
+		size_t rowOf(int64_t y) const;
+		void partition(const RectangleStore &store, std::vector<size_t> &starts, std::vector<size_t> &entries) const;
+
+		/* Internal Members */
+		int64_t originX{0};
+		int64_t originY{0};
+		int64_t tileWidth{1};
+		int64_t tileHeight{1};
+		size_t columns{0};
+		size_t rows{0};
+		// Per side, the rectangles of every tile in a single array (compressed rows)
+		std::vector<size_t> firstStarts;
+		std::vector<size_t> firstEntries;
+		std::vector<size_t> secondStarts;
+		std::vector<size_t> secondEntries;
+};
+
+} // namespace nitro
+#endif // NITRO_PARTITIONJOIN_HPP
@@ -0,0 +1,54 @@
+#ifndef NITRO_RTREE_HPP
+#define NITRO_RTREE_HPP
+
+#include "IntersectionKernel.hpp"
+#include "RectangleStore.hpp"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace nitro {
+
+/* RTree is a static R-tree over the rectangles of a RectangleStore, bulk loaded with Sort-Tile-Recursive packing.
+   Nodes are kept in a single array with the root at the end; each node stores the bounding boxes of its entries
+   as one kernel block, so a node is tested with a single IntersectionKernel call.
+   The tree refers to rectangles by their store index, and the same store must be passed to every operation. */
+class RTree {
+	public:
+		/* Defines */
+		static constexpr size_t NODE_CAPACITY = IntersectionKernel::BLOCK_SIZE;
+
+		// Called once per overlapping pair, with the store indices (first < second) and the overlapping region
+		using PairCallback = std::function<void(size_t first, size_t second, int left, int top, int right, int bottom)>;
+
+		/* Constructors, Destructors */
+		RTree() = default;
+		explicit RTree(const RectangleStore &store);
+		~RTree() = default;
+
+		/* Getters */
+		size_t getNodeCount() const;
+		size_t getHeight() const;
+
+		/* Functions */
+		void forEachPair(const RectangleStore &store, const PairCallback &callback) const;
+		std::vector<size_t> queryPoint(int x, int y) const;
+		std::vector<size_t> queryWindow(int left, int top, int right, int bottom) const;
+
+	private:
+		/* Internal Types */
+		struct Node {
+				IntersectionKernel::Block boxes;
+				// Child node indices, or store indices in leaves
+				size_t entries[NODE_CAPACITY];
+				size_t count;
+				bool leaf;
+		};
+
+		/* Internal Members */
+		std::vector<Node> nodes;
+		size_t height{0};
+};
+
+} // namespace nitro
+#endif // NITRO_RTREE_HPP
@@ -1,6 +1,7 @@
 #ifndef NITRO_RECTANGLE_HPP
 #define NITRO_RECTANGLE_HPP
 
+#include "Box.hpp"
 #include "Vertex.hpp"
 #include <cstdint>
 #include <optional>
@@ -26,6 +27,12 @@ class Rectangle {
 		Rectangle(ID id, Vertex topLeft, uint32_t width, uint32_t height);
 		~Rectangle() = default;
 
+		// Unchecked construction for boxes derived from rectangles that were already validated, such as their
+		// overlaps: the box must not be a point and the id is taken as is
+		static Rectangle fromBox(ID id, const Box &box) noexcept {
+			return Rectangle{id, box};
+		}
+
 		/* Operators */
 		// implement strict weak ordering, requirement of std::set
 		bool operator<(const Rectangle &other) const {
@@ -34,9 +41,7 @@ class Rectangle {
 
 		// implement equality
 		bool operator==(const Rectangle &other) const {
-			return this->getVertices().topLeft.x == other.getVertices().topLeft.x &&
-			       this->getVertices().topLeft.y == other.getVertices().topLeft.y &&
-			       this->getWidth() == other.getWidth() && this->getHeight() == other.getHeight();
+			return this->box == other.box;
 		}
 
 		/* Getters and Setters */
@@ -46,21 +51,44 @@ class Rectangle {
 		uint32_t getWidth() const;
 		uint32_t getHeight() const;
 
+		// Copy-free views of the edges, for hot paths
+		const Box &getBox() const {
+			return box;
+		}
+
+		int getLeft() const {
+			return box.left;
+		}
+
+		int getTop() const {
+			return box.top;
+		}
+
+		int getRight() const {
+			return box.right;
+		}
+
+		int getBottom() const {
+			return box.bottom;
+		}
+
 		/* Functions */
 		static std::optional<Rectangle> intersection(const Rectangle &rectangle1, const Rectangle &rectangle2);
 		std::optional<Rectangle> intersect(const Rectangle &rectangle);
 		std::string toString() const;
 
 	private:
+		/* Constructors */
+		Rectangle(ID id, const Box &box) noexcept : id(id), box(box) {}
+
 		/* Internal Functions */
 		static bool validateVertices(const Vertex &bottomLeft, const Vertex &bottomRight, const Vertex &topLeft,
 		                             const Vertex &topRight);
 
 		/* Internal Members */
+		// The vertices, width and height are all derived from the edges
 		ID id;
-		Vertices vertices;
-		uint32_t width;
-		uint32_t height;
+		Box box;
 };
 
 } // namespace nitro
@@ -3,8 +3,12 @@
 
 #include "Canvas.hpp"
 #include "Rectangle.hpp"
+#include <algorithm>
+#include <memory_resource>
 #include <optional>
 #include <set>
+#include <span>
+#include <vector>
 
 #ifdef TEST
 #include <gtest/gtest.h>
@@ -14,41 +18,79 @@ namespace nitro {
 /* RectangleIntersection specifically interoperates with information stored in Canvas.
    A RectangleIntersection can only be created through Canvas intersection functions.
    A RectangleIntersection stores IDs of intersecting rectangles and the shape of the intersection.
+   The IDs are kept sorted in a small inline array, and only intersections of many rectangles allocate.
+   Those take their IDs from the memory resource given to them, the heap by default. Copies, constructed or assigned,
+   always allocate from the heap, while a moved RectangleIntersection keeps the memory resource of its source.
    To get the shape of the intersecting rectangles, the Canvas::getRectangleAtIndex() function is required. */
 class Canvas::RectangleIntersection {
 	public:
 		/* Constructors, Destructors */
-		// Anyone can copy or move a RectangleIntersection
+		// Anyone can copy or move a RectangleIntersection. A moved-from RectangleIntersection has no members.
 		RectangleIntersection(const RectangleIntersection &) = default;
-		RectangleIntersection(RectangleIntersection &&) = default;
-		RectangleIntersection &operator=(const RectangleIntersection &) = default;
-		RectangleIntersection &operator=(RectangleIntersection &&) = default;
+		RectangleIntersection(RectangleIntersection &&other) noexcept;
+		RectangleIntersection &operator=(const RectangleIntersection &other);
+		RectangleIntersection &operator=(RectangleIntersection &&other) noexcept;
 		~RectangleIntersection() = default;
 
+		/* Defines */
+		// Number of IDs stored without a heap allocation
+		static constexpr size_t INLINE_MEMBERS = 4;
+
 		/* Operators */
 		// implement strict weak ordering, requirement of std::set
 		bool operator<(const RectangleIntersection &other) const {
-			if (this->getIntersectingRectangles().size() != other.getIntersectingRectangles().size()) {
-				return this->getIntersectingRectangles().size() < other.getIntersectingRectangles().size();
+			if (this->memberCount != other.memberCount) {
+				return this->memberCount < other.memberCount;
 			}
-			return this->getIntersectingRectangles() < other.getIntersectingRectangles();
+			const std::span<const Rectangle::ID> members = this->getMembers();
+			const std::span<const Rectangle::ID> otherMembers = other.getMembers();
+			return std::lexicographical_compare(members.begin(), members.end(), otherMembers.begin(),
+			                                    otherMembers.end());
 		}
 
 		/* Functions */
 		Rectangle getShape() const;
+		// Copy-free views, valid as long as the RectangleIntersection is. getMembers() is the view of
+		// getIntersectingRectangles().
+		const Rectangle &getShapeRef() const {
+			return shape;
+		}
 		std::set<Rectangle::ID> getIntersectingRectangles() const;
 		Rectangle::ID getRectIdAtIndex(size_t index) const;
+		bool contains(Rectangle::ID id) const;
 		std::string toString() const;
 
+		// Ascending IDs of the intersecting rectangles, valid as long as the RectangleIntersection is
+		std::span<const Rectangle::ID> getMembers() const {
+			return {memberCount <= INLINE_MEMBERS ? inlineMembers : spilledMembers.data(), memberCount};
+		}
+
+		size_t getMemberCount() const {
+			return memberCount;
+		}
+
 	private:
 		friend class Canvas;
-		/* Private Constructor */
+		/* Private Constructors */
 		// Only Canvas can create a RectangleIntersection through its intersection functions
 		RectangleIntersection(const Rectangle &shape, const std::set<Rectangle::ID> &members);
+		RectangleIntersection(const Rectangle &shape, Rectangle::ID first, Rectangle::ID second);
+		// members must be sorted in ascending order
+		RectangleIntersection(const Rectangle &shape, std::span<const Rectangle::ID> members);
+		// Adds a rectangle that is not yet a member of base
+		RectangleIntersection(const Rectangle &shape, const RectangleIntersection &base, Rectangle::ID member,
+		                      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+		/* Internal Functions */
+		Rectangle::ID *allocateMembers(size_t count);
+		// Replaces the spilled members along with their memory resource, which assigning them would keep
+		void adoptSpilledMembers(std::pmr::vector<Rectangle::ID> &&members) noexcept;
 
 		/* Internal Members */
 		Rectangle shape;
-		std::set<Rectangle::ID> intersectingRectangles;
+		uint32_t memberCount{0};
+		Rectangle::ID inlineMembers[INLINE_MEMBERS]{};
+		std::pmr::vector<Rectangle::ID> spilledMembers;
 
 		/* For Testing */
 #ifdef TEST
@@ -56,6 +98,11 @@ class Canvas::RectangleIntersection {
 		FRIEND_TEST(RectangleIntersectionTest, TestRectangleIntersectionSetOrdering);
 		FRIEND_TEST(RectangleIntersectionTest, TestIntersectionAbstraction);
 		FRIEND_TEST(RectangleIntersectionTest, GetIndexOutOfBounds);
+		FRIEND_TEST(RectangleIntersectionTest, MembersAreKeptSorted);
+		FRIEND_TEST(RectangleIntersectionTest, MembersSpillBeyondInlineCapacity);
+		FRIEND_TEST(RectangleIntersectionTest, OrderingBySizeThenMembers);
+		FRIEND_TEST(RectangleIntersectionTest, MovingLeavesNoMembers);
+		FRIEND_TEST(RectangleIntersectionTest, AssignmentLeavesTheArena);
 #endif
 };
 
@@ -0,0 +1,87 @@
+#ifndef NITRO_RECTANGLESTORE_HPP
+#define NITRO_RECTANGLESTORE_HPP
+
+#include "Rectangle.hpp"
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace nitro {
+
+/* RectangleStore keeps rectangles as a structure of arrays: one contiguous array per edge and one for the IDs.
+   Passes over the canvas read only the edges they need, and any rectangle can be reached in O(1),
+   either by its index or through its ID. */
+class RectangleStore {
+	public:
+		/* Constructors, Destructors */
+		RectangleStore() = default;
+		~RectangleStore() = default;
+
+		/* Getters */
+		size_t size() const;
+		bool empty() const;
+		Rectangle at(size_t index) const;
+		std::optional<size_t> indexOf(Rectangle::ID id) const;
+
+		Rectangle::ID getId(size_t index) const;
+		int getLeft(size_t index) const;
+		int getTop(size_t index) const;
+		int getRight(size_t index) const;
+		int getBottom(size_t index) const;
+
+		std::span<const Rectangle::ID> getIds() const;
+		std::span<const int> getLefts() const;
+		std::span<const int> getTops() const;
+		std::span<const int> getRights() const;
+		std::span<const int> getBottoms() const;
+
+		/* Functions */
+		void reserve(size_t capacity);
+		void push_back(const Rectangle &rectangle);
+		// Moves the last rectangle into the erased slot, so only the index of that rectangle changes
+		void erase(size_t index);
+		void clear();
+
+	private:
+		/* Internal Members */
+		std::vector<Rectangle::ID> ids;
+		std::vector<int> lefts;
+		std::vector<int> tops;
+		std::vector<int> rights;
+		std::vector<int> bottoms;
+		std::unordered_map<Rectangle::ID, size_t> indices;
+};
+
+/* Inline accessors: called from the innermost loops of the intersection passes */
+inline size_t RectangleStore::size() const {
+	return ids.size();
+}
+
+inline bool RectangleStore::empty() const {
+	return ids.empty();
+}
+
+inline Rectangle::ID RectangleStore::getId(size_t index) const {
+	return ids[index];
+}
+
+inline int RectangleStore::getLeft(size_t index) const {
+	return lefts[index];
+}
+
+inline int RectangleStore::getTop(size_t index) const {
+	return tops[index];
+}
+
+inline int RectangleStore::getRight(size_t index) const {
+	return rights[index];
+}
+
+inline int RectangleStore::getBottom(size_t index) const {
+	return bottoms[index];
+}
+
+} // namespace nitro
+#endif // NITRO_RECTANGLESTORE_HPP
@@ -0,0 +1,70 @@
+#ifndef NITRO_THREADPOOL_HPP
+#define NITRO_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nitro {
+
+/* ThreadPool runs batches of independent tasks on a fixed set of worker threads.
+   Every worker starts with its own queue of tasks and, once it runs dry, steals tasks from the other queues,
+   so a few expensive tasks don't leave the other workers idle.
+   A pool with a single thread runs every task on the calling thread. */
+class ThreadPool {
+	public:
+		/* Defines */
+		// Called once per task, with the task number and the number of the worker running it
+		using Task = std::function<void(size_t task, size_t worker)>;
+
+		/* Constructors, Destructors */
+		// threadCount == 0 uses one thread per hardware thread
+		explicit ThreadPool(size_t threadCount);
+		~ThreadPool();
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		/* Getters */
+		size_t getThreadCount() const;
+
+		/* Functions */
+		// Runs task for every task number in [0, taskCount) and waits for all of them to finish.
+		// The first exception thrown by a task is rethrown here. Tasks must not call run() on the same pool.
+		void run(size_t taskCount, const Task &task);
+
+	private:
+		/* Internal Types */
+		struct WorkerQueue {
+				std::mutex mutex;
+				std::deque<size_t> tasks;
+		};
+
+		/* Internal Functions */
+		void workerLoop(size_t worker);
+		void drainQueues(size_t worker);
+		bool nextTask(size_t worker, size_t &task);
+
+		/* Internal Members */
+		size_t threadCount;
+		std::vector<std::thread> threads;
+		std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+		std::mutex runMutex;
+		std::mutex stateMutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workFinished;
+		const Task *currentTask{nullptr};
+		size_t generation{0};
+		size_t busyWorkers{0};
+		bool stopping{false};
+		std::exception_ptr error;
+};
+
+} // namespace nitro
+#endif // NITRO_THREADPOOL_HPP
@@ -0,0 +1,103 @@
+#ifndef NITRO_TILEDINTERSECTOR_HPP
+#define NITRO_TILEDINTERSECTOR_HPP
+
+#include "Canvas.hpp"
+#include "Rectangle.hpp"
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace nitro {
+
+/* TiledIntersector finds the intersections of inputs that don't fit in memory at once.
+   The extent of the input is cut into a grid of tiles and every rectangle is spilled to a temporary file for each
+   tile it touches. Tiles are then loaded and intersected one at a time, so memory follows the largest tile instead
+   of the whole input. An intersection shows up in every tile its region touches, and is only reported by the tile
+   holding the top left corner of its region.
+   The input is passed twice, in the same order: once to measure() to find its extent, once to spill().
+   When the extent spans at most 65536 units on both axes, tile files store 16 bit offsets from its top left
+   corner, which makes records 12 bytes instead of 20. */
+class TiledIntersector {
+	public:
+		/* Defines */
+		static const size_t DEFAULT_RECTANGLES_PER_TILE = 100000;
+		// Rectangles buffered per tile before they are appended to its file
+		static const size_t WRITE_BUFFER_RECORDS = 1024;
+
+		/* Constructors, Destructors */
+		// Tile files are kept in a new directory inside directory, which is removed again by the destructor
+		explicit TiledIntersector(const std::filesystem::path &directory,
+		                          size_t rectanglesPerTile = DEFAULT_RECTANGLES_PER_TILE);
+		~TiledIntersector();
+		TiledIntersector(const TiledIntersector &) = delete;
+		TiledIntersector &operator=(const TiledIntersector &) = delete;
+
+		/* Getters and Setters */
+		size_t getRectangleCount() const;
+		// Zero until the first rectangle is spilled
+		size_t getTileCount() const;
+		// Size of a rectangle in the tile files, zero until the first rectangle is spilled
+		size_t getRecordSize() const;
+		// Intersections the tiles went through in the last streamIntersections(), those left to other tiles included
+		size_t getExaminedCount() const;
+		const std::filesystem::path &getDirectory() const;
+		// The threads are started once, and every tile is intersected on them
+		void setThreadCount(size_t threadCount);
+		// maxOrder and memoryBudget apply to every tile, maxResults to the whole input
+		void setLimits(const Canvas::Limits &limits);
+
+		/* Functions */
+		void measure(const Rectangle &rectangle);
+		void spill(const Rectangle &rectangle);
+		// Passes every intersection to sink once, grouped by tile and ordered like intersectAll() within a tile
+		Canvas::LimitReached streamIntersections(const Canvas::IntersectionSink &sink);
+
+	private:
+		/* Internal Types */
+		// A rectangle as written to a tile file, with its edges relative to the record origin
+		template <typename Coordinate> struct Record {
+				Rectangle::ID id;
+				BasicBox<Coordinate> box;
+		};
+
+		/* Internal Functions */
+		void layout();
+		template <typename Coordinate> void spillAs(const Rectangle &rectangle);
+		template <typename Coordinate> void loadAs(std::ifstream &file, std::vector<Rectangle> &rectangles) const;
+		void flush(size_t tile);
+		std::vector<Rectangle> loadTile(size_t tile) const;
+		std::filesystem::path tilePath(size_t tile) const;
+		size_t columnOf(int64_t x) const;
+		size_t rowOf(int64_t y) const;
+
+		/* Internal Members */
+		std::filesystem::path directory;
+		size_t rectanglesPerTile;
+		// Lent to the Canvas of every tile, nullptr runs on the calling thread
+		std::shared_ptr<ThreadPool> threadPool;
+		Canvas::Limits limits;
+
+		size_t rectangleCount{0};
+		int64_t minX;
+		int64_t minY;
+		int64_t maxX;
+		int64_t maxY;
+
+		int64_t tileWidth{1};
+		int64_t tileHeight{1};
+		size_t columns{0};
+		size_t rows{0};
+		bool narrowRecords{false};
+		int64_t recordOriginX{0};
+		int64_t recordOriginY{0};
+		size_t examinedCount{0};
+		// Encoded records waiting to be appended to each tile file
+		std::vector<std::vector<char>> buffers;
+};
+
+} // namespace nitro
+#endif // NITRO_TILEDINTERSECTOR_HPP
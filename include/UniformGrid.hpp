@@ -0,0 +1,56 @@
+#ifndef NITRO_UNIFORMGRID_HPP
+#define NITRO_UNIFORMGRID_HPP
+
+#include "IntersectionKernel.hpp"
+#include "RectangleStore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nitro {
+
+/* UniformGrid bins the rectangles of a RectangleStore into square cells of a fixed size.
+   A rectangle is listed in every cell it touches, so only rectangles sharing a cell need to be compared.
+   Cells are kept in a single array (compressed rows), with no allocation per cell.
+   The grid refers to rectangles by their store index, and the same store must be passed to every operation. */
+class UniformGrid {
+	public:
+		/* Defines */
+		// Pick the cell size from the mean rectangle extent
+		static const int64_t AUTOMATIC_CELL_SIZE = 0;
+
+		// Called once per overlapping pair, with the store indices (first < second) and the overlapping region
+		using PairCallback = std::function<void(size_t first, size_t second, int left, int top, int right, int bottom)>;
+
+		/* Constructors, Destructors */
+		UniformGrid() = default;
+		explicit UniformGrid(const RectangleStore &store, int64_t cellSize = AUTOMATIC_CELL_SIZE);
+		~UniformGrid() = default;
+
+		/* Getters */
+		int64_t getCellSize() const;
+		size_t getColumnCount() const;
+		size_t getRowCount() const;
+
+		/* Functions */
+		void forEachPair(const RectangleStore &store, const PairCallback &callback) const;
+
+	private:
+		/* Internal Functions */
+		size_t columnOf(int64_t x) const;
+		size_t rowOf(int64_t y) const;
+
+		/* Internal Members */
+		int64_t cellSize{1};
+		int64_t originX{0};
+		int64_t originY{0};
+		size_t columns{0};
+		size_t rows{0};
+		// Rectangles of cell c are cellEntries[cellStarts[c]] up to cellEntries[cellStarts[c + 1]]
+		std::vector<size_t> cellStarts;
+		std::vector<size_t> cellEntries;
+};
+
+} // namespace nitro
+#endif // NITRO_UNIFORMGRID_HPP
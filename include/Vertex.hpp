@@ -2,10 +2,12 @@
 #define NITRO_VERTEX_HPP
 
 namespace nitro {
-typedef struct {
-		int x;
-		int y;
-} Vertex;
+template <typename Coordinate> struct BasicVertex {
+		Coordinate x;
+		Coordinate y;
+};
+
+using Vertex = BasicVertex<int>;
 
 } // namespace nitro
 #endif // NITRO_VERTEX_HPP
\ No newline at end of file
@@ -1,27 +1,89 @@
 #include "Application.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <limits>
 #include <optional>
 
 namespace nitro {
 
-Application::Application(int argc, char **argv) : initialized(false), maxRectangles(Application::DEFAULT_MAX_RECTS) {
+namespace {
+
+// Parses a non-negative integer option value. With allowSuffix, the value may end in K, M or G (powers of 1024)
+std::optional<size_t> parseOptionNumber(const std::string &value, bool allowSuffix) {
+	if (value.empty() || value[0] < '0' || value[0] > '9') {
+		return std::nullopt;
+	}
+
+	try {
+		size_t end = 0;
+		unsigned long long number = std::stoull(value, &end);
+		if (end == value.size()) {
+			return static_cast<size_t>(number);
+		}
+		if (!allowSuffix || end + 1 != value.size()) {
+			return std::nullopt;
+		}
+
+		const std::string suffixes = "KMG";
+		const size_t suffix = suffixes.find(static_cast<char>(std::toupper(value[end])));
+		if (suffix == std::string::npos) {
+			return std::nullopt;
+		}
+		const unsigned shift = 10 * static_cast<unsigned>(suffix + 1);
+		if (number > (std::numeric_limits<size_t>::max() >> shift)) {
+			return std::nullopt;
+		}
+		return static_cast<size_t>(number) << shift;
+	} catch (const std::exception &e) {
+		return std::nullopt;
+	}
+}
+
+} // namespace
+
+Application::Application(int argc, char **argv)
+    : initialized(false), maxRectangles(Application::DEFAULT_MAX_RECTS), threadCount(1),
+      outputMode(OutputMode::Intersections), rectanglesPerTile(0) {
 	this->initialized = init(argc, argv);
 }
 
 bool Application::init(int argc, char **argv) {
-	if (ErrorCode code = checkArgCount(argc); code != ErrorCode::Success) {
+	// Options start with "--" and may appear anywhere, every other argument is positional
+	std::vector<char *> positional{argv[0]};
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]).starts_with("--")) {
+			if (ErrorCode code = parseOption(argc, argv, i); code != ErrorCode::Success) {
+				reportError(code);
+				printHelp();
+				return false;
+			}
+		} else {
+			positional.push_back(argv[i]);
+		}
+	}
+
+	// Tiles are only ever used to list intersections
+	if (this->rectanglesPerTile != 0 && this->outputMode != OutputMode::Intersections) {
+		reportError(ErrorCode::IncompatibleOptions);
+		printHelp();
+		return false;
+	}
+
+	if (ErrorCode code = checkArgCount(static_cast<int>(positional.size())); code != ErrorCode::Success) {
 		reportError(code);
 		printHelp();
 		return false;
 	}
 
-	if (argc == 3) {
-		if (ErrorCode code = parseMaxRects(argv[2]); code != ErrorCode::Success) {
+	if (positional.size() == 3) {
+		if (ErrorCode code = parseMaxRects(positional[2]); code != ErrorCode::Success) {
 			reportError(code);
 			return false;
 		}
 	}
 
-	std::string path = argv[1];
+	std::string path = positional[1];
 
 	if (ErrorCode code = parseFile(path); code != ErrorCode::Success) {
 		reportError(code);
@@ -37,12 +99,40 @@ int Application::run() {
 	}
 
 	try {
+		// Output is buffered and written in large blocks; whatever was printed is flushed before an error is reported
+		OutputWriter out{std::cout};
+		if (this->rectanglesPerTile != 0) {
+			printTiledOutput(out);
+			return 0;
+		}
+
 		std::vector<Rectangle> rectangles = loadRectangles(this->maxRectangles);
+		if (this->coordinates.has_value()) {
+			// Ranks keep which rectangles intersect and where, but not any length or area
+			if (this->outputMode != OutputMode::Intersections) {
+				throw std::runtime_error("Rectangle coordinates beyond 32 bits can only be used to list intersections");
+			}
+			out.setCoordinateMap(&this->coordinates.value());
+		}
 
 		this->canvas = Canvas{rectangles};
-		std::vector<Canvas::RectangleIntersection> intersections = this->canvas.intersectAll();
+		this->canvas.setThreadCount(this->threadCount);
+		this->canvas.setLimits(this->limits);
 
-		printOutput(rectangles, intersections);
+		switch (this->outputMode) {
+			case OutputMode::Intersections:
+				printOutput(out, rectangles, this->canvas);
+				break;
+			case OutputMode::Counts:
+				printCounts(out, rectangles, this->canvas);
+				break;
+			case OutputMode::Coverage:
+				printCoverage(out, rectangles, this->canvas);
+				break;
+			case OutputMode::Statistics:
+				printStatistics(out, rectangles, this->canvas);
+				break;
+		}
 
 	} catch (const std::exception &e) {
 		std::cerr << "Error: " << e.what() << "\n";
@@ -80,9 +170,64 @@ Application::ErrorCode Application::parseMaxRects(const char *arg) {
 	return ErrorCode::Success;
 }
 
+Application::ErrorCode Application::parseOption(int argc, char **argv, int &index) {
+	// Consumes the option at argv[index] and its value, if it takes one
+	std::string option(argv[index]);
+	if (option == "--count-only") {
+		this->outputMode = OutputMode::Counts;
+		return ErrorCode::Success;
+	}
+	if (option == "--coverage") {
+		this->outputMode = OutputMode::Coverage;
+		return ErrorCode::Success;
+	}
+	if (option == "--statistics") {
+		this->outputMode = OutputMode::Statistics;
+		return ErrorCode::Success;
+	}
+
+	if (option != "--threads" && option != "--max-order" && option != "--max-results" &&
+	    option != "--memory-budget" && option != "--tiled") {
+		return ErrorCode::UnknownOption;
+	}
+
+	if (index + 1 >= argc) {
+		return ErrorCode::MissingOptionValue;
+	}
+	std::optional<size_t> value =
+	    parseOptionNumber(argv[++index], option == "--memory-budget" || option == "--tiled");
+	if (!value.has_value()) {
+		return ErrorCode::InvalidOptionValue;
+	}
+
+	if (option == "--threads") {
+		this->threadCount = value.value();
+	} else if (option == "--max-order") {
+		// An intersection always has at least 2 rectangles
+		if (value.value() == 1) {
+			return ErrorCode::InvalidOptionValue;
+		}
+		this->limits.maxOrder = value.value();
+	} else if (option == "--max-results") {
+		this->limits.maxResults = value.value();
+	} else if (option == "--tiled") {
+		this->rectanglesPerTile = value.value();
+	} else {
+		this->limits.memoryBudget = value.value();
+	}
+
+	return ErrorCode::Success;
+}
+
 Application::ErrorCode Application::parseFile(const std::string &path) {
 	try {
-		jsonHandler.loadFile(path);
+		// Tiled runs stream the file later on, instead of loading it whole
+		if (this->rectanglesPerTile != 0) {
+			JsonHandler::openFile(path);
+		} else {
+			jsonHandler.loadFile(path);
+		}
+		this->inputPath = path;
 	} catch (const std::exception &e) {
 		std::cerr << "Error: " << e.what() << "\n";
 		return ErrorCode::InvalidFile;
@@ -91,40 +236,185 @@ Application::ErrorCode Application::parseFile(const std::string &path) {
 	return ErrorCode::Success;
 }
 
-std::vector<Rectangle> Application::loadRectangles(const size_t maxRectangles) const {
+std::vector<Rectangle> Application::loadRectangles(const size_t maxRectangles) {
+	this->coordinates.reset();
 	std::optional<json> j = jsonHandler.getArray("rects", maxRectangles);
 	if (!j.has_value()) {
 		return std::vector<Rectangle>();
 	}
-	std::optional<std::vector<Rectangle>> rects = JsonHandler::unmarshal<std::vector<Rectangle>>(j);
-	return rects.has_value() ? rects.value() : std::vector<Rectangle>();
+	std::optional<std::vector<WideBox>> boxes = JsonHandler::unmarshal<std::vector<WideBox>>(j);
+	if (!boxes.has_value()) {
+		return std::vector<Rectangle>();
+	}
+
+	std::vector<Rectangle> rects;
+	rects.reserve(boxes.value().size());
+	if (std::all_of(boxes.value().begin(), boxes.value().end(), CoordinateMap::fits)) {
+		Rectangle::ID id = 1;
+		for (const WideBox &box : boxes.value()) {
+			rects.emplace_back(id++, Vertex{static_cast<int>(box.left), static_cast<int>(box.top)},
+			                   static_cast<uint32_t>(box.right - box.left),
+			                   static_cast<uint32_t>(box.bottom - box.top));
+		}
+		return rects;
+	}
+
+	// The whole input is mapped, so that every rectangle keeps its position relative to the others
+	const CoordinateMap &coordinates = this->coordinates.emplace(boxes.value());
+	Rectangle::ID id = 1;
+	for (const WideBox &box : boxes.value()) {
+		rects.push_back(coordinates.compress(id++, box));
+	}
+	return rects;
 }
 
-void Application::printOutput(const std::vector<Rectangle> &rectangles,
-                              const std::vector<Canvas::RectangleIntersection> &intersections) const {
-	std::cout << "Input:\n";
+bool Application::printInput(OutputWriter &out, const std::vector<Rectangle> &rectangles) const {
+	// Returns false when there is nothing else to print
+	out << "Input:\n";
 	if (rectangles.empty()) {
-		std::cout << "   No rectangles have been defined.\n";
+		out << "   No rectangles have been defined.\n";
+		return false;
+	}
+
+	for (const Rectangle &rectangle : rectangles) {
+		out << "   " << rectangle << "\n";
+	}
+	return true;
+}
+
+void Application::printOutput(OutputWriter &out, const std::vector<Rectangle> &rectangles,
+                              const Canvas &canvas) const {
+	if (!printInput(out, rectangles)) {
+		return;
+	}
+
+	// Intersections are printed as they are found, so the full output is never held in memory
+	out << "\nIntersections:\n";
+	size_t intersectionCount = 0;
+	Canvas::LimitReached limitReached =
+	    canvas.streamIntersections([&out, &intersectionCount](const Canvas::RectangleIntersection &intersection) {
+		    out << "   " << intersection << "\n";
+		    intersectionCount++;
+	    });
+
+	if (intersectionCount == 0) {
+		out << "   No intersections were found.\n";
+	}
+	// The warning goes to stderr, after everything printed so far
+	out.flush();
+	reportLimit(limitReached);
+}
+
+void Application::printCounts(OutputWriter &out, const std::vector<Rectangle> &rectangles,
+                              const Canvas &canvas) const {
+	if (!printInput(out, rectangles)) {
 		return;
 	}
 
-	for (Rectangle rectangle : rectangles) {
-		std::cout << "   " << rectangle.toString() << "\n";
+	out << "\nIntersection counts:\n";
+	std::vector<Canvas::OrderSummary> summary = canvas.countIntersections();
+	if (summary.empty()) {
+		out << "   No intersections were found.\n";
+	}
+
+	for (const Canvas::OrderSummary &order : summary) {
+		out << "   " << order.order << " rectangles: " << order.count << " intersections, total area "
+		    << order.area << "\n";
+	}
+}
+
+void Application::printCoverage(OutputWriter &out, const std::vector<Rectangle> &rectangles,
+                                const Canvas &canvas) const {
+	if (!printInput(out, rectangles)) {
+		return;
 	}
 
-	std::cout << "\nIntersections:\n";
-	if (intersections.empty()) {
-		std::cout << "   No intersections were found.\n";
+	out << "\nCoverage:\n";
+	CoverageSweep coverage{canvas.getRectangleStore()};
+	if (coverage.getMaxDepth() == 0) {
+		out << "   No area is covered.\n";
 		return;
 	}
 
-	for (Canvas::RectangleIntersection intersection : intersections) {
-		std::cout << "   " << intersection.toString() << "\n";
+	out << "   Maximum depth: " << coverage.getMaxDepth() << "\n";
+	std::vector<uint64_t> areas = coverage.computeAreaByDepth(canvas.getRectangleStore());
+	for (size_t depth = 1; depth < areas.size(); depth++) {
+		out << "   Depth " << depth << ": total area " << areas[depth] << "\n";
+	}
+
+	out << "   Regions at maximum depth:\n";
+	for (const CoverageSweep::Region &region : coverage.getMaxDepthRegions()) {
+		out << "      (" << region.left << ", " << region.top << ") w=" << region.right - region.left
+		    << ", h=" << region.bottom - region.top << "\n";
 	}
 }
 
+void Application::printStatistics(OutputWriter &out, const std::vector<Rectangle> &rectangles,
+                                  const Canvas &canvas) const {
+	if (!printInput(out, rectangles)) {
+		return;
+	}
+
+	out << "\nStatistics:\n";
+	CoverageSweep::Statistics statistics = canvas.computeStatistics();
+	out << "   Union area: " << statistics.unionArea << "\n"
+	    << "   Summed pairwise overlap area: " << statistics.overlapArea << "\n";
+	if (statistics.boundingBox.has_value()) {
+		const CoverageSweep::Region &box = statistics.boundingBox.value();
+		out << "   Bounding box: (" << box.left << ", " << box.top << ") w=" << box.right - box.left
+		    << ", h=" << box.bottom - box.top << "\n";
+	} else {
+		out << "   Bounding box: none\n";
+	}
+}
+
+void Application::printTiledOutput(OutputWriter &out) const {
+	// The input is read twice, first to print it and find its extent, then to spill it to the tile files
+	TiledIntersector tiles{std::filesystem::temp_directory_path(), this->rectanglesPerTile};
+	tiles.setThreadCount(this->threadCount);
+	tiles.setLimits(this->limits);
+
+	out << "Input:\n";
+	JsonHandler::streamRectangles(this->inputPath, "rects", this->maxRectangles,
+	                              [&out, &tiles](const Rectangle &rectangle) {
+		                              out << "   " << rectangle << "\n";
+		                              tiles.measure(rectangle);
+	                              });
+	if (tiles.getRectangleCount() == 0) {
+		out << "   No rectangles have been defined.\n";
+		return;
+	}
+	JsonHandler::streamRectangles(this->inputPath, "rects", this->maxRectangles,
+	                              [&tiles](const Rectangle &rectangle) { tiles.spill(rectangle); });
+
+	out << "\nIntersections:\n";
+	size_t intersectionCount = 0;
+	Canvas::LimitReached limitReached =
+	    tiles.streamIntersections([&out, &intersectionCount](const Canvas::RectangleIntersection &intersection) {
+		    out << "   " << intersection << "\n";
+		    intersectionCount++;
+	    });
+
+	if (intersectionCount == 0) {
+		out << "   No intersections were found.\n";
+	}
+	// The warning goes to stderr, after everything printed so far
+	out.flush();
+	reportLimit(limitReached);
+}
+
 void Application::printHelp() {
-	std::cout << "Usage: ./rectangle_intersect <path/to/file.json> [max_rectangles]\n";
+	std::cout << "Usage: ./rectangle_intersect <path/to/file.json> [max_rectangles] [options]\n"
+	          << "Options:\n"
+	          << "   --threads N           Number of threads used to find intersections (0: every hardware thread)\n"
+	          << "   --max-order K         Largest number of rectangles in a reported intersection (at least 2)\n"
+	          << "   --max-results N       Maximum number of intersections reported\n"
+	          << "   --count-only          Only print the number and total area of the intersections of each order\n"
+	          << "   --coverage            Print the maximum overlap depth, area per depth and deepest regions\n"
+	          << "   --statistics          Print the union area, summed pairwise overlap area and bounding box\n"
+	          << "   --memory-budget SIZE  Approximate memory for the enumeration, in bytes or with a K/M/G suffix\n"
+	          << "   --tiled N             Stream the input through temporary tile files of about N rectangles each\n"
+	          << "Limits default to 0, which means no limit.\n";
 }
 
 void Application::reportError(ErrorCode code) const {
@@ -143,6 +433,38 @@ void Application::reportError(ErrorCode code) const {
 		case ErrorCode::InvalidSizeArg:
 			std::cerr << "Error: Invalid size argument. Must be a non-negative integer.\n";
 			break;
+		case ErrorCode::UnknownOption:
+			std::cerr << "Error: Unknown option.\n";
+			break;
+		case ErrorCode::MissingOptionValue:
+			std::cerr << "Error: Missing value for option.\n";
+			break;
+		case ErrorCode::InvalidOptionValue:
+			std::cerr << "Error: Invalid option value.\n";
+			break;
+		case ErrorCode::IncompatibleOptions:
+			std::cerr << "Error: --tiled can only be used to list intersections.\n";
+			break;
+	}
+}
+
+void Application::reportLimit(Canvas::LimitReached limitReached) const {
+	// The intersections found so far have been printed, this only explains why the list is incomplete
+	switch (limitReached) {
+		case Canvas::LimitReached::None:
+			break;
+		case Canvas::LimitReached::MaxOrder:
+			std::cerr << "Warning: Stopped at the maximum intersection order (" << this->limits.maxOrder
+			          << "), intersections of more rectangles were not reported.\n";
+			break;
+		case Canvas::LimitReached::MaxResults:
+			std::cerr << "Warning: Stopped at the maximum number of results (" << this->limits.maxResults
+			          << "), further intersections were not reported.\n";
+			break;
+		case Canvas::LimitReached::MemoryBudget:
+			std::cerr << "Warning: Stopped at the memory budget (" << this->limits.memoryBudget
+			          << " bytes), further intersections were not reported.\n";
+			break;
 	}
 }
 
@@ -1,24 +1,440 @@
 #include "Canvas.hpp"
+#include "CountingResource.hpp"
+#include "IdSetTable.hpp"
+#include "IntersectionKernel.hpp"
 #include "RectangleIntersection.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
 
 namespace nitro {
 
-Canvas::Canvas(const std::vector<Rectangle> &input) {
-	std::set<Rectangle::ID> seen;
-	for (const auto &rect : input) {
-		int id = rect.getId();
-		if (seen.find(id) != seen.end()) {
-			throw std::invalid_argument("Duplicate ID: " + std::to_string(id));
+namespace {
+
+// Strips per worker thread in the parallel sweep, so that idle workers can steal the strips of busy ones
+const size_t STRIPS_PER_THREAD = 4;
+
+// Chunks per worker thread when a level of higher-order intersections is expanded in parallel
+const size_t CHUNKS_PER_THREAD = 8;
+
+// A vertical edge of a rectangle, visited in ascending X order by the sweep line
+struct SweepEvent {
+		int x;
+		bool opening;
+		size_t index;
+		// Position of the rectangle in the active intervals
+		size_t slot;
+
+		bool operator<(const SweepEvent &other) const {
+			if (x != other.x) {
+				return x < other.x;
+			}
+			// Closing edges go first: rectangles that only touch at an X coordinate don't intersect
+			return !opening && other.opening;
+		}
+};
+
+// Vertical extents of the rectangles crossed by the sweep line. Every rectangle has a fixed slot, in ascending order
+// of its top edge, and a max tree over the slots holds the bottom edge of every active rectangle.
+// A query only descends into subtrees with an active rectangle that reaches below the query's top edge, so it visits
+// O((k + 1) log n) nodes for k overlapping rectangles, however many rectangles are active.
+class ActiveIntervals {
+	public:
+		// tops must be sorted in ascending order
+		explicit ActiveIntervals(std::vector<int> tops) : tops(std::move(tops)) {
+			while (leafCount < this->tops.size()) {
+				leafCount *= 2;
+			}
+			bottoms.assign(2 * leafCount, INACTIVE);
+		}
+
+		void activate(size_t slot, int bottom) {
+			update(slot, bottom);
+		}
+
+		void deactivate(size_t slot) {
+			update(slot, INACTIVE);
+		}
+
+		// Calls visit(slot, top, bottom), in slot order, for every active interval overlapping [top, bottom)
+		template <typename Visit> void forEachOverlap(int top, int bottom, Visit &&visit) const {
+			// Slots from limit on start at or below the bottom edge
+			const size_t limit = std::lower_bound(tops.begin(), tops.end(), bottom) - tops.begin();
+			visitOverlaps(1, 0, leafCount, limit, top, visit);
+		}
+
+	private:
+		static constexpr int INACTIVE = std::numeric_limits<int>::min();
+
+		void update(size_t slot, int bottom) {
+			size_t node = leafCount + slot;
+			bottoms[node] = bottom;
+			for (node /= 2; node > 0; node /= 2) {
+				bottoms[node] = std::max(bottoms[2 * node], bottoms[2 * node + 1]);
+			}
+		}
+
+		template <typename Visit>
+		void visitOverlaps(size_t node, size_t begin, size_t end, size_t limit, int top, Visit &visit) const {
+			if (begin >= limit || bottoms[node] <= top) {
+				return;
+			}
+			if (end - begin == 1) {
+				visit(begin, tops[begin], bottoms[node]);
+				return;
+			}
+			const size_t middle = (begin + end) / 2;
+			visitOverlaps(2 * node, begin, middle, limit, top, visit);
+			visitOverlaps(2 * node + 1, middle, end, limit, top, visit);
+		}
+
+		std::vector<int> tops;
+		size_t leafCount{1};
+		std::vector<int> bottoms;
+};
+
+// Sweeps a vertical line across the given rectangles, stopping at every left and right edge.
+// Rectangles crossed by the line are kept in ActiveIntervals, so an opening rectangle is only tested against the
+// active rectangles that overlap it vertically.
+// report(first, second, left, top, right, bottom) is called once for every overlapping pair.
+template <typename Report>
+void sweepPairs(const RectangleStore &store, const std::vector<size_t> &indices, Report &&report) {
+	// Line rectangles have no area, so they can never be part of an intersection
+	std::vector<size_t> slots;
+	slots.reserve(indices.size());
+	for (size_t i : indices) {
+		if (store.getLeft(i) != store.getRight(i) && store.getTop(i) != store.getBottom(i)) {
+			slots.push_back(i);
+		}
+	}
+	std::sort(slots.begin(), slots.end(), [&](size_t a, size_t b) {
+		return std::pair{store.getTop(a), a} < std::pair{store.getTop(b), b};
+	});
+
+	std::vector<int> tops;
+	std::vector<SweepEvent> events;
+	tops.reserve(slots.size());
+	events.reserve(slots.size() * 2);
+	for (size_t slot = 0; slot < slots.size(); slot++) {
+		const size_t i = slots[slot];
+		tops.push_back(store.getTop(i));
+		events.push_back({store.getLeft(i), true, i, slot});
+		events.push_back({store.getRight(i), false, i, slot});
+	}
+	std::sort(events.begin(), events.end());
+
+	ActiveIntervals active{std::move(tops)};
+	IntersectionKernel::Block block;
+	IntersectionKernel::Block clipped;
+	size_t candidates[IntersectionKernel::BLOCK_SIZE];
+	for (const SweepEvent &event : events) {
+		if (!event.opening) {
+			active.deactivate(event.slot);
+			continue;
+		}
+
+		// Overlapping rectangles are clipped by the kernel, a block at a time
+		const size_t i = event.index;
+		size_t count = 0;
+		const auto flush = [&]() {
+			const uint32_t hits =
+			    IntersectionKernel::intersect(store.getLeft(i), store.getTop(i), store.getRight(i), store.getBottom(i),
+			                                  block.lefts, block.tops, block.rights, block.bottoms, count, clipped);
+			for (size_t c = 0; c < count; c++) {
+				if ((hits & (1u << c)) != 0) {
+					report(i, candidates[c], clipped.lefts[c], clipped.tops[c], clipped.rights[c], clipped.bottoms[c]);
+				}
+			}
+			count = 0;
+		};
+
+		active.forEachOverlap(store.getTop(i), store.getBottom(i), [&](size_t slot, int otherTop, int otherBottom) {
+			// The other rectangle opened earlier and is still crossed by the sweep line, so they overlap on X
+			const size_t other = slots[slot];
+			candidates[count] = other;
+			block.lefts[count] = store.getLeft(other);
+			block.tops[count] = otherTop;
+			block.rights[count] = store.getRight(other);
+			block.bottoms[count] = otherBottom;
+			if (++count == IntersectionKernel::BLOCK_SIZE) {
+				flush();
+			}
+		});
+		if (count > 0) {
+			flush();
+		}
+		active.activate(event.slot, store.getBottom(i));
+	}
+}
+
+// Shape of an overlap with a positive area, which can't fail the checks of the Rectangle constructor
+Rectangle makeShape(int left, int top, int right, int bottom) {
+	return Rectangle::fromBox(Rectangle::ID_UNDEFINED, {left, top, right, bottom});
+}
+
+// Splits [0, count) into chunks, runs body(begin, end, output) for every chunk on the pool, or on the calling
+// thread without one, and returns the outputs in chunk order
+template <typename T, typename Body>
+std::vector<std::vector<T>> runInChunks(ThreadPool *pool, size_t count, Body &&body) {
+	const size_t chunkTarget = pool ? pool->getThreadCount() * CHUNKS_PER_THREAD : 1;
+	const size_t chunkCount = std::max<size_t>(1, std::min(count, chunkTarget));
+	std::vector<std::vector<T>> outputs(chunkCount);
+	if (pool) {
+		pool->run(chunkCount, [&](size_t chunk, size_t) {
+			body(chunk * count / chunkCount, (chunk + 1) * count / chunkCount, outputs[chunk]);
+		});
+	} else {
+		body(0, count, outputs[0]);
+	}
+	return outputs;
+}
+
+// Interleaves the bits of x and y into their position along a Z-order curve
+uint64_t mortonCode(uint32_t x, uint32_t y) {
+	const auto spread = [](uint64_t value) {
+		value = (value | (value << 16)) & 0x0000FFFF0000FFFFull;
+		value = (value | (value << 8)) & 0x00FF00FF00FF00FFull;
+		value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		value = (value | (value << 2)) & 0x3333333333333333ull;
+		value = (value | (value << 1)) & 0x5555555555555555ull;
+		return value;
+	};
+	return spread(x) | (spread(y) << 1);
+}
+
+// Combinations of rectangle IDs that several threads can fill at once. Combinations are spread over shards
+// by their fingerprint, and every shard is a hash table with its own lock.
+class ConcurrentIdSets {
+	public:
+		// Returns false if the combination was already there
+		bool insert(std::span<const Rectangle::ID> ids) {
+			const uint64_t fingerprint = IdSetTable::fingerprint(ids);
+			// The table picks slots with the low bits, so shards are picked with the high ones
+			Shard &shard = shards[(fingerprint >> 58) % shards.size()];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			return shard.table.insert(ids, fingerprint);
+		}
+
+		// Not to be called while other threads insert
+		Canvas::IdSetStatistics getStatistics() const {
+			Canvas::IdSetStatistics statistics;
+			double probes = 0.0;
+			for (const Shard &shard : shards) {
+				const IdSetTable &table = shard.table;
+				statistics.entries += table.size();
+				statistics.capacity += table.getCapacity();
+				statistics.lookups += table.getLookupCount();
+				probes += table.getAverageProbeLength() * static_cast<double>(table.getLookupCount());
+				statistics.maxProbeLength = std::max(statistics.maxProbeLength, table.getMaxProbeLength());
+				statistics.collisions += table.getCollisionCount();
+			}
+			if (statistics.capacity != 0) {
+				statistics.loadFactor =
+				    static_cast<double>(statistics.entries) / static_cast<double>(statistics.capacity);
+			}
+			if (statistics.lookups != 0) {
+				statistics.averageProbeLength = probes / static_cast<double>(statistics.lookups);
+			}
+			return statistics;
+		}
+
+	private:
+		struct Shard {
+				std::mutex mutex;
+				IdSetTable table;
+		};
+
+		std::array<Shard, 64> shards;
+};
+
+// Approximate number of bytes held for an intersection while it is enumerated and kept in the result
+size_t footprint(const Canvas::RectangleIntersection &intersection) {
+	// A std::set node carries three pointers and a color next to its value
+	const size_t setNode = 4 * sizeof(void *);
+	const size_t spilled = intersection.getMemberCount() > Canvas::RectangleIntersection::INLINE_MEMBERS
+	                           ? intersection.getMemberCount() * sizeof(Rectangle::ID)
+	                           : 0;
+	return sizeof(Canvas::RectangleIntersection) + setNode + spilled;
+}
+
+size_t footprint(const std::set<Canvas::RectangleIntersection> &intersections) {
+	size_t bytes = 0;
+	for (const Canvas::RectangleIntersection &intersection : intersections) {
+		bytes += footprint(intersection);
+	}
+	return bytes;
+}
+
+// Memory accounting of one level of the enumeration, shared by the threads expanding it
+class LevelBudget {
+	public:
+		// budget == 0 means no limit; used is what is already held before the level
+		LevelBudget(size_t budget, size_t used) : budget{budget}, used{used} {}
+
+		// Returns false once the level no longer fits in the budget
+		bool reserve(size_t bytes) {
+			if (budget == 0) {
+				return true;
+			}
+			if (used + levelBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes <= budget) {
+				return true;
+			}
+			exceeded.store(true, std::memory_order_relaxed);
+			return false;
+		}
+
+		bool isExceeded() const {
+			return exceeded.load(std::memory_order_relaxed);
+		}
+
+	private:
+		size_t budget;
+		size_t used;
+		std::atomic<size_t> levelBytes{0};
+		std::atomic<bool> exceeded{false};
+};
+
+// Overlap graph of the pairwise intersections: for every store index, the ascending list of overlapping
+// rectangles stored after it. Rectangles are stored in ascending ID order, so these are the neighbors with a larger ID.
+std::vector<std::vector<size_t>> buildLargerNeighbors(const RectangleStore &store,
+                                                      const std::set<Canvas::RectangleIntersection> &pairwise) {
+	std::vector<std::vector<size_t>> largerNeighbors(store.size());
+	for (const Canvas::RectangleIntersection &intersection : pairwise) {
+		const size_t index1 = store.indexOf(intersection.getRectIdAtIndex(0)).value();
+		const size_t index2 = store.indexOf(intersection.getRectIdAtIndex(1)).value();
+		largerNeighbors[std::min(index1, index2)].push_back(std::max(index1, index2));
+	}
+	for (std::vector<size_t> &neighbors : largerNeighbors) {
+		std::sort(neighbors.begin(), neighbors.end());
+	}
+	return largerNeighbors;
+}
+
+// Intersection of two ascending index lists
+std::vector<size_t> commonIndices(const std::vector<size_t> &indices1, const std::vector<size_t> &indices2) {
+	std::vector<size_t> result;
+	std::set_intersection(indices1.begin(), indices1.end(), indices2.begin(), indices2.end(),
+	                      std::back_inserter(result));
+	return result;
+}
+
+// Monotonic arena of one chunk of the enumeration. requests counts what the enumeration asked for, blocks what the
+// arena took from the heap to serve it.
+struct Arena {
+		CountingResource blocks{std::pmr::new_delete_resource()};
+		std::pmr::monotonic_buffer_resource buffer{&blocks};
+		CountingResource requests{&buffer};
+};
+
+// Same as above, with the result copied into the arena at its exact size. scratch is reused between calls.
+std::span<const size_t> commonIndices(std::span<const size_t> indices1, std::span<const size_t> indices2,
+                                      std::pmr::vector<size_t> &scratch, std::pmr::memory_resource &arena) {
+	scratch.clear();
+	std::set_intersection(indices1.begin(), indices1.end(), indices2.begin(), indices2.end(),
+	                      std::back_inserter(scratch));
+	if (scratch.empty()) {
+		return {};
+	}
+
+	size_t *copy = static_cast<size_t *>(arena.allocate(scratch.size() * sizeof(size_t), alignof(size_t)));
+	std::copy(scratch.begin(), scratch.end(), copy);
+	return {copy, scratch.size()};
+}
+
+// Depth-first walk over the neighbors of one rectangle that calls emit(chosen, left, top, right, bottom) for every
+// combination of the neighbors from first on, in list order, that still overlaps the region of the rectangle
+template <typename Emit>
+void walkNeighborhood(const RectangleStore &store, const std::vector<size_t> &neighbors, size_t first,
+                      std::vector<size_t> &chosen, int left, int top, int right, int bottom, Emit &&emit) {
+	for (size_t n = first; n < neighbors.size(); n++) {
+		const size_t index = neighbors[n];
+		const int clippedLeft = std::max(left, store.getLeft(index));
+		const int clippedTop = std::max(top, store.getTop(index));
+		const int clippedRight = std::min(right, store.getRight(index));
+		const int clippedBottom = std::min(bottom, store.getBottom(index));
+		if (clippedLeft >= clippedRight || clippedTop >= clippedBottom) {
+			continue;
+		}
+
+		chosen.push_back(index);
+		emit(chosen, clippedLeft, clippedTop, clippedRight, clippedBottom);
+		walkNeighborhood(store, neighbors, n + 1, chosen, clippedLeft, clippedTop, clippedRight, clippedBottom, emit);
+		chosen.pop_back();
+	}
+}
+
+// Adds an intersection of order rectangles to the per order summary, which is indexed by order - 2
+void tally(std::vector<Canvas::OrderSummary> &summary, size_t order, int left, int top, int right, int bottom) {
+	if (summary.size() < order - 1) {
+		summary.resize(order - 1);
+	}
+	Canvas::OrderSummary &entry = summary[order - 2];
+	entry.order = order;
+	entry.count++;
+	entry.area += static_cast<uint64_t>(static_cast<int64_t>(right) - left) *
+	              static_cast<uint64_t>(static_cast<int64_t>(bottom) - top);
+}
+
+// Depth-first walk that tallies every intersection extending an intersection of order rectangles, whatever its
+// order. candidates are the common larger neighbors of its members. maxOrder == 0 walks to the deepest order.
+void tallyIntersections(const RectangleStore &store, const std::vector<std::vector<size_t>> &largerNeighbors,
+                        size_t maxOrder, size_t order, int left, int top, int right, int bottom,
+                        const std::vector<size_t> &candidates, std::vector<Canvas::OrderSummary> &summary) {
+	if (maxOrder != 0 && order >= maxOrder) {
+		return;
+	}
+
+	for (size_t index : candidates) {
+		const int clippedLeft = std::max(left, store.getLeft(index));
+		const int clippedTop = std::max(top, store.getTop(index));
+		const int clippedRight = std::min(right, store.getRight(index));
+		const int clippedBottom = std::min(bottom, store.getBottom(index));
+		if (clippedLeft >= clippedRight || clippedTop >= clippedBottom) {
+			continue;
 		}
 
-		seen.insert(id);
-		rectangles.insert(rect);
+		tally(summary, order + 1, clippedLeft, clippedTop, clippedRight, clippedBottom);
+		tallyIntersections(store, largerNeighbors, maxOrder, order + 1, clippedLeft, clippedTop, clippedRight,
+		                   clippedBottom, commonIndices(candidates, largerNeighbors[index]), summary);
+	}
+}
+
+} // namespace
+
+Canvas::Canvas(const std::vector<Rectangle> &input) {
+	// Rectangles are stored in ascending ID order, so that index == ID - 1 for IDs assigned on load.
+	// Only their positions are sorted, the rectangles are copied once, straight into the store.
+	std::vector<size_t> order(input.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	                 [&input](size_t a, size_t b) { return input[a].getId() < input[b].getId(); });
+
+	rectangles.reserve(input.size());
+	for (size_t index : order) {
+		rectangles.push_back(input[index]);
 	}
 }
 
 std::set<Rectangle> Canvas::getRectangles() const {
+	std::set<Rectangle> result;
+	for (size_t i = 0; i < rectangles.size(); i++) {
+		result.insert(result.end(), rectangles.at(i));
+	}
+	return result;
+}
+
+const RectangleStore &Canvas::getRectangleStore() const {
 	return rectangles;
 }
 
@@ -27,96 +443,925 @@ size_t Canvas::getRectangleCount() const {
 }
 
 Rectangle Canvas::getRectangleAtIndex(size_t index) const {
-	if (index >= rectangles.size()) {
-		throw std::out_of_range("Index out of range");
+	return rectangles.at(index);
+}
+
+Canvas::PairwiseEngine Canvas::getPairwiseEngine() const {
+	return pairwiseEngine;
+}
+
+void Canvas::setPairwiseEngine(PairwiseEngine engine) {
+	this->pairwiseEngine = engine;
+}
+
+size_t Canvas::getThreadCount() const {
+	return threadPool ? threadPool->getThreadCount() : 1;
+}
+
+void Canvas::setThreadCount(size_t threadCount) {
+	// Thread count 0 uses every hardware thread
+	this->threadPool = threadCount == 1 ? nullptr : std::make_shared<ThreadPool>(threadCount);
+}
+
+void Canvas::setThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+	this->threadPool = std::move(threadPool);
+}
+
+int64_t Canvas::getGridCellSize() const {
+	return gridCellSize;
+}
+
+void Canvas::setGridCellSize(int64_t cellSize) {
+	// UniformGrid::AUTOMATIC_CELL_SIZE derives the cell size from the rectangles
+	this->gridCellSize = cellSize;
+	this->dynamicIndex.reset();
+}
+
+Canvas::EnumerationStrategy Canvas::getEnumerationStrategy() const {
+	return enumerationStrategy;
+}
+
+void Canvas::setEnumerationStrategy(EnumerationStrategy strategy) {
+	this->enumerationStrategy = strategy;
+}
+
+Canvas::Limits Canvas::getLimits() const {
+	return limits;
+}
+
+void Canvas::setLimits(const Limits &limits) {
+	if (limits.maxOrder == 1) {
+		throw std::invalid_argument("Maximum intersection order must be at least 2");
 	}
+	this->limits = limits;
+}
+
+const std::vector<Canvas::LevelAllocations> &Canvas::getLevelAllocations() const {
+	return levelAllocations;
+}
 
-	auto it = rectangles.begin();
-	std::advance(it, index);
-	return *it;
+const Canvas::IdSetStatistics &Canvas::getIdSetStatistics() const {
+	return idSetStatistics;
+}
+
+Canvas::LimitReached Canvas::getLimitReached() const {
+	return limitReached;
 }
 
 const std::vector<Canvas::RectangleIntersection> Canvas::intersectAll() {
+	this->limitReached = LimitReached::None;
+	this->levelAllocations.clear();
+	this->idSetStatistics = {};
+	if (!this->ordered) {
+		this->restoreOrder();
+	}
+
 	std::optional<std::set<Canvas::RectangleIntersection>> pairwiseIntersections =
 	    this->determinePairwiseIntersections();
 
 	if (pairwiseIntersections.has_value()) {
-		std::optional<std::set<Canvas::RectangleIntersection>> allIntersections =
-		    this->determineAllIntersections(pairwiseIntersections.value());
-		return std::vector<Canvas::RectangleIntersection>(allIntersections.value().begin(),
-		                                                  allIntersections.value().end());
+		// Determines all higher-order intersections: intersections with 3+ intersecting rectangles
+		return this->collectAllIntersections(pairwiseIntersections.value(), this->enumerationStrategy);
 	}
 
 	return std::vector<Canvas::RectangleIntersection>();
 }
 
-std::optional<std::set<Canvas::RectangleIntersection>> Canvas::determinePairwiseIntersections() {
+Canvas::LimitReached Canvas::streamIntersections(const IntersectionSink &sink) const {
+	return this->streamIntersectionsWhile([&sink](const RectangleIntersection &intersection) {
+		sink(intersection);
+		return true;
+	});
+}
+
+Canvas::LimitReached Canvas::streamIntersectionsWhile(const StoppingSink &sink) const {
+	// Intersections are emitted in the order of intersectAll(): by number of rectangles, then by their IDs.
+	// Levels are expanded on the thread pool exactly as intersectAll() does, and every level is handed to the sink
+	// as soon as it is complete. Only the pairwise intersections, the overlap graph and the levels being expanded
+	// are held, never the intersections already emitted.
+	std::optional<std::set<RectangleIntersection>> pairwiseIntersections = this->determinePairwiseIntersections();
+	if (!pairwiseIntersections.has_value()) {
+		return LimitReached::None;
+	}
+
+	Enumeration enumeration{sink, 0, footprint(pairwiseIntersections.value()), false};
+	for (const RectangleIntersection &intersection : pairwiseIntersections.value()) {
+		if (!enumeration.emit(intersection, this->limits.maxResults)) {
+			return enumeration.limitReached;
+		}
+	}
+	if (this->limits.memoryBudget != 0 && enumeration.heldBytes > this->limits.memoryBudget) {
+		return LimitReached::MemoryBudget;
+	}
+
+	// The enumeration relies on the store being in ID order, which edits don't keep
+	RectangleStore sortedCopy;
+	if (!this->ordered) {
+		sortedCopy = this->sortedStore();
+	}
+	const RectangleStore &store = this->ordered ? this->rectangles : sortedCopy;
+	this->enumerate(store, pairwiseIntersections.value(), this->enumerationStrategy, enumeration);
+	return enumeration.limitReached;
+}
+
+std::vector<Canvas::OrderSummary> Canvas::countIntersections() const {
+	// Works on store indices and edges only: the overlap graph is the only structure that grows with the number
+	// of intersections, and every higher-order intersection is counted as the walk passes it
+	const RectangleStore &store = this->rectangles;
+	std::vector<std::vector<size_t>> largerNeighbors(store.size());
+	std::vector<OrderSummary> summary;
+	this->forEachPairwiseIntersection([&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		largerNeighbors[std::min(first, second)].push_back(std::max(first, second));
+		tally(summary, 2, left, top, right, bottom);
+	});
+	if (summary.empty()) {
+		return summary;
+	}
+	for (std::vector<size_t> &neighbors : largerNeighbors) {
+		std::sort(neighbors.begin(), neighbors.end());
+	}
+
+	// A walk is started from every pairwise intersection. The pairs are split into chunks on the thread pool,
+	// rather than the rectangles, since a few rectangles can take part in most of the intersections.
+	std::vector<size_t> pairStarts(store.size() + 1, 0);
+	for (size_t i = 0; i < store.size(); i++) {
+		pairStarts[i + 1] = pairStarts[i] + largerNeighbors[i].size();
+	}
+
+	const size_t maxOrder = this->limits.maxOrder;
+	auto count = [&](size_t begin, size_t end, std::vector<OrderSummary> &chunkSummary) {
+		size_t i = std::upper_bound(pairStarts.begin(), pairStarts.end(), begin) - pairStarts.begin() - 1;
+		for (size_t pair = begin; pair < end; pair++) {
+			while (pair >= pairStarts[i + 1]) {
+				i++;
+			}
+			const size_t neighbor = largerNeighbors[i][pair - pairStarts[i]];
+			const int left = std::max(store.getLeft(i), store.getLeft(neighbor));
+			const int top = std::max(store.getTop(i), store.getTop(neighbor));
+			const int right = std::min(store.getRight(i), store.getRight(neighbor));
+			const int bottom = std::min(store.getBottom(i), store.getBottom(neighbor));
+			tallyIntersections(store, largerNeighbors, maxOrder, 2, left, top, right, bottom,
+			                   commonIndices(largerNeighbors[i], largerNeighbors[neighbor]), chunkSummary);
+		}
+	};
+
+	for (const std::vector<OrderSummary> &chunkSummary :
+	     runInChunks<OrderSummary>(this->threadPool.get(), pairStarts.back(), count)) {
+		for (const OrderSummary &order : chunkSummary) {
+			// Chunks have no pairwise entries, and may leave other orders empty
+			if (order.count == 0) {
+				continue;
+			}
+			if (summary.size() < order.order - 1) {
+				summary.resize(order.order - 1);
+			}
+			OrderSummary &total = summary[order.order - 2];
+			total.order = order.order;
+			total.count += order.count;
+			total.area += order.area;
+		}
+	}
+
+	return summary;
+}
+
+CoverageSweep::Statistics Canvas::computeStatistics() const {
+	return CoverageSweep::computeStatistics(this->rectangles);
+}
+
+std::vector<Canvas::JoinPair> Canvas::join(const Canvas &other) const {
+	// Tiles are joined independently, and every pair is only reported by a single tile
+	const PartitionJoin partitions{this->rectangles, other.rectangles};
+	const auto joinTiles = [&](size_t begin, size_t end, std::vector<JoinPair> &output) {
+		for (size_t tile = begin; tile < end; tile++) {
+			partitions.joinTile(this->rectangles, other.rectangles, tile,
+			                    [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+				                    output.push_back({this->rectangles.getId(first), other.rectangles.getId(second),
+				                                      makeShape(left, top, right, bottom)});
+			                    });
+		}
+	};
+
+	std::vector<JoinPair> result;
+	for (std::vector<JoinPair> &chunk :
+	     runInChunks<JoinPair>(this->threadPool.get(), partitions.getTileCount(), joinTiles)) {
+		std::move(chunk.begin(), chunk.end(), std::back_inserter(result));
+	}
+	std::sort(result.begin(), result.end(), [](const JoinPair &a, const JoinPair &b) {
+		return std::tie(a.first, a.second) < std::tie(b.first, b.second);
+	});
+	return result;
+}
+
+Canvas::Query Canvas::Query::point(int x, int y) {
+	return {x, y, x, y};
+}
+
+Canvas::Query Canvas::Query::window(const Rectangle &window) {
+	return {window.getLeft(), window.getTop(), window.getRight(), window.getBottom()};
+}
+
+std::vector<Canvas::RectangleIntersection> Canvas::insert(const Rectangle &rectangle) {
+	if (this->rectangles.indexOf(rectangle.getId()).has_value()) {
+		throw std::invalid_argument("Duplicate ID: " + std::to_string(rectangle.getId()));
+	}
+
+	DynamicGrid &index = this->getDynamicIndex();
+	const bool appendsInOrder =
+	    this->rectangles.empty() || this->rectangles.getId(this->rectangles.size() - 1) < rectangle.getId();
+	this->ordered = this->ordered && appendsInOrder;
+	this->rectangles.push_back(rectangle);
+	this->queryTree.reset();
+
+	const size_t position = this->rectangles.size() - 1;
+	index.insert(rectangle.getId(), this->rectangles.getLeft(position), this->rectangles.getTop(position),
+	             this->rectangles.getRight(position), this->rectangles.getBottom(position));
+	return this->determineLocalIntersections(position);
+}
+
+std::vector<Canvas::RectangleIntersection> Canvas::erase(Rectangle::ID id) {
+	std::optional<size_t> position = this->rectangles.indexOf(id);
+	if (!position.has_value()) {
+		throw std::invalid_argument("Unknown ID: " + std::to_string(id));
+	}
+
+	DynamicGrid &index = this->getDynamicIndex();
+	std::vector<RectangleIntersection> removed = this->determineLocalIntersections(position.value());
+	index.erase(id, this->rectangles.getLeft(position.value()), this->rectangles.getTop(position.value()),
+	            this->rectangles.getRight(position.value()), this->rectangles.getBottom(position.value()));
+
+	// The last rectangle takes the place of the erased one
+	this->ordered = this->ordered && position.value() == this->rectangles.size() - 1;
+	this->rectangles.erase(position.value());
+	this->queryTree.reset();
+	return removed;
+}
+
+std::vector<Rectangle::ID> Canvas::queryPoint(int x, int y) {
+	this->buildQueryIndex();
+	return this->queryIndex(x, y, x, y);
+}
+
+std::vector<Rectangle::ID> Canvas::queryWindow(const Rectangle &window) {
+	const Query query = Query::window(window);
+	this->buildQueryIndex();
+	return this->queryIndex(query.left, query.top, query.right, query.bottom);
+}
+
+std::vector<std::vector<Rectangle::ID>> Canvas::queryBatch(const std::vector<Query> &queries) {
+	std::vector<std::vector<Rectangle::ID>> results(queries.size());
+	if (queries.empty()) {
+		return results;
+	}
+	this->buildQueryIndex();
+
+	// Queries are sorted by the Z-order code of their centres, taken relative to the lowest centre
+	int64_t minX = std::numeric_limits<int64_t>::max();
+	int64_t minY = std::numeric_limits<int64_t>::max();
+	for (const Query &query : queries) {
+		minX = std::min(minX, static_cast<int64_t>(query.left) + query.right);
+		minY = std::min(minY, static_cast<int64_t>(query.top) + query.bottom);
+	}
+	std::vector<std::pair<uint64_t, size_t>> order;
+	order.reserve(queries.size());
+	for (size_t i = 0; i < queries.size(); i++) {
+		const int64_t x = (static_cast<int64_t>(queries[i].left) + queries[i].right - minX) / 2;
+		const int64_t y = (static_cast<int64_t>(queries[i].top) + queries[i].bottom - minY) / 2;
+		order.push_back({mortonCode(static_cast<uint32_t>(x), static_cast<uint32_t>(y)), i});
+	}
+	std::sort(order.begin(), order.end());
+
+	// Chunks are runs of the curve, and their results are moved back to the position of their query
+	using Answer = std::pair<size_t, std::vector<Rectangle::ID>>;
+	const auto answer = [&](size_t begin, size_t end, std::vector<Answer> &output) {
+		for (size_t i = begin; i < end; i++) {
+			const Query &query = queries[order[i].second];
+			output.push_back({order[i].second, this->queryIndex(query.left, query.top, query.right, query.bottom)});
+		}
+	};
+	for (std::vector<Answer> &chunk : runInChunks<Answer>(this->threadPool.get(), order.size(), answer)) {
+		for (Answer &entry : chunk) {
+			results[entry.first] = std::move(entry.second);
+		}
+	}
+	return results;
+}
+
+void Canvas::buildQueryIndex() {
+	// Once the canvas has been edited its grid is kept up to date, while the R-tree would need a rebuild
+	if (!this->dynamicIndex.has_value() && !this->queryTree.has_value()) {
+		this->queryTree.emplace(this->rectangles);
+	}
+}
+
+std::vector<Rectangle::ID> Canvas::queryIndex(int left, int top, int right, int bottom) const {
+	std::vector<size_t> indices;
+	if (this->dynamicIndex.has_value()) {
+		indices = this->dynamicIndex->queryWindow(this->rectangles, left, top, right, bottom);
+	} else {
+		indices = this->queryTree->queryWindow(left, top, right, bottom);
+	}
+
+	std::vector<Rectangle::ID> result;
+	result.reserve(indices.size());
+	for (size_t index : indices) {
+		result.push_back(this->rectangles.getId(index));
+	}
+	// Store indices follow ID order only until the first edit
+	if (!this->ordered) {
+		std::sort(result.begin(), result.end());
+	}
+	return result;
+}
+
+std::vector<Canvas::RectangleIntersection> Canvas::determineLocalIntersections(size_t index) const {
+	// Every intersection of the rectangle at index is a combination of the rectangles overlapping it
+	const RectangleStore &store = this->rectangles;
+	const int left = store.getLeft(index);
+	const int top = store.getTop(index);
+	const int right = store.getRight(index);
+	const int bottom = store.getBottom(index);
+
+	std::vector<size_t> neighbors;
+	if (left < right && top < bottom) {
+		for (size_t other : this->dynamicIndex->queryWindow(store, left, top, right, bottom)) {
+			if (other != index && std::max(left, store.getLeft(other)) < std::min(right, store.getRight(other)) &&
+			    std::max(top, store.getTop(other)) < std::min(bottom, store.getBottom(other))) {
+				neighbors.push_back(other);
+			}
+		}
+	}
+	std::sort(neighbors.begin(), neighbors.end(),
+	          [&store](size_t a, size_t b) { return store.getId(a) < store.getId(b); });
+
+	std::vector<RectangleIntersection> result;
+	std::vector<Rectangle::ID> ids;
+	std::vector<size_t> members;
+	walkNeighborhood(store, neighbors, 0, members, left, top, right, bottom,
+	                 [&](const std::vector<size_t> &chosen, int l, int t, int r, int b) {
+		                 ids.assign(1, store.getId(index));
+		                 for (size_t member : chosen) {
+			                 ids.push_back(store.getId(member));
+		                 }
+		                 std::sort(ids.begin(), ids.end());
+		                 result.push_back({makeShape(l, t, r, b), std::span<const Rectangle::ID>{ids}});
+	                 });
+
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+DynamicGrid &Canvas::getDynamicIndex() {
+	if (!this->dynamicIndex.has_value()) {
+		this->dynamicIndex.emplace(this->rectangles, this->gridCellSize);
+	}
+	return this->dynamicIndex.value();
+}
+
+RectangleStore Canvas::sortedStore() const {
+	std::vector<size_t> order(this->rectangles.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(),
+	          [this](size_t a, size_t b) { return this->rectangles.getId(a) < this->rectangles.getId(b); });
+
+	RectangleStore sorted;
+	sorted.reserve(order.size());
+	for (size_t index : order) {
+		sorted.push_back(this->rectangles.at(index));
+	}
+	return sorted;
+}
+
+void Canvas::restoreOrder() {
+	this->rectangles = this->sortedStore();
+	this->ordered = true;
+	this->queryTree.reset();
+}
+
+void Canvas::forEachPairwiseIntersection(const PairCallback &callback) const {
+	// Same pairs as determinePairwiseIntersections(), reported by store index without building intersections
+	const RectangleStore &store = this->rectangles;
+	switch (this->pairwiseEngine) {
+		case PairwiseEngine::BruteForce:
+			for (size_t i = 0; i < store.size(); i++) {
+				for (size_t j = i + 1; j < store.size(); j++) {
+					const int left = std::max(store.getLeft(i), store.getLeft(j));
+					const int top = std::max(store.getTop(i), store.getTop(j));
+					const int right = std::min(store.getRight(i), store.getRight(j));
+					const int bottom = std::min(store.getBottom(i), store.getBottom(j));
+					if (left < right && top < bottom) {
+						callback(i, j, left, top, right, bottom);
+					}
+				}
+			}
+			break;
+		case PairwiseEngine::SweepLine:
+			if (this->threadPool) {
+				this->forEachPairParallel(callback);
+			} else {
+				std::vector<size_t> indices(store.size());
+				std::iota(indices.begin(), indices.end(), 0);
+				sweepPairs(store, indices, callback);
+			}
+			break;
+		case PairwiseEngine::Grid:
+			UniformGrid{store, this->gridCellSize}.forEachPair(store, callback);
+			break;
+		case PairwiseEngine::RTree:
+			nitro::RTree{store}.forEachPair(store, callback);
+			break;
+	}
+}
+
+std::optional<std::set<Canvas::RectangleIntersection>> Canvas::determinePairwiseIntersections() const {
 	// Determines all 2nd-order intersections: intersections that only have 2 intersecting rectangles
 	// Utilized as the basis to determine all higher order intersections
 	std::set<Canvas::RectangleIntersection> result;
+	switch (this->pairwiseEngine) {
+		case PairwiseEngine::BruteForce:
+			result = this->determinePairwiseIntersectionsBruteForce();
+			break;
+		case PairwiseEngine::SweepLine:
+			result = this->threadPool ? this->determinePairwiseIntersectionsParallel()
+			                          : this->determinePairwiseIntersectionsSweepLine();
+			break;
+		case PairwiseEngine::Grid:
+			result = this->determinePairwiseIntersectionsGrid();
+			break;
+		case PairwiseEngine::RTree:
+			result = this->determinePairwiseIntersectionsRTree();
+			break;
+	}
+
+	return result.empty() ? std::nullopt : std::make_optional(result);
+}
+
+std::set<Canvas::RectangleIntersection> Canvas::determinePairwiseIntersectionsBruteForce() const {
+	// Reference implementation: tests every pair of rectangles
+	std::set<Canvas::RectangleIntersection> result;
 	for (size_t i = 0; i < this->rectangles.size(); i++) {
 		for (size_t j = i + 1; j < this->rectangles.size(); j++) {
-			Rectangle rectangle1 = this->getRectangleAtIndex(i);
-			Rectangle rectangle2 = this->getRectangleAtIndex(j);
-			std::optional<Rectangle> intersection = Rectangle::intersection(rectangle1, rectangle2);
-			if (intersection.has_value()) {
-				Canvas::RectangleIntersection rectangleIntersection{intersection.value(),
-				                                                    {rectangle1.getId(), rectangle2.getId()}};
-				result.insert(rectangleIntersection);
+			const int left = std::max(this->rectangles.getLeft(i), this->rectangles.getLeft(j));
+			const int top = std::max(this->rectangles.getTop(i), this->rectangles.getTop(j));
+			const int right = std::min(this->rectangles.getRight(i), this->rectangles.getRight(j));
+			const int bottom = std::min(this->rectangles.getBottom(i), this->rectangles.getBottom(j));
+			if (left < right && top < bottom) {
+				result.insert({makeShape(left, top, right, bottom), this->rectangles.getId(i),
+				               this->rectangles.getId(j)});
 			}
 		}
 	}
 
-	return result.empty() ? std::nullopt : std::make_optional(result);
+	return result;
 }
 
-std::optional<std::set<Canvas::RectangleIntersection>>
-Canvas::determineAllIntersections(const std::set<RectangleIntersection> &pairwiseIntersections) {
-	// Determines all higher-order intersections: intersections with 3+ intersecting rectangles
-	std::set<RectangleIntersection> result{pairwiseIntersections.begin(), pairwiseIntersections.end()};
-	std::vector<RectangleIntersection> current{pairwiseIntersections.begin(), pairwiseIntersections.end()};
-	std::set<std::set<Rectangle::ID>> intersectionsFound;
+std::set<Canvas::RectangleIntersection> Canvas::determinePairwiseIntersectionsSweepLine() const {
+	const RectangleStore &store = this->rectangles;
+	std::vector<size_t> indices(store.size());
+	std::iota(indices.begin(), indices.end(), 0);
 
-	bool moreIntersectionsHappened = true;
-	while (moreIntersectionsHappened) {
-		moreIntersectionsHappened = false;
-		std::vector<RectangleIntersection> next;
-		for (const RectangleIntersection &intersection : current) {
-			// All intersections are considered as virtual rectangles that can be intersected with the actual rectangles
-			// in order to form new higher-order intersections, that will be considered as virtual rectangles in the
-			// next iteration
-			for (size_t i = 0; i < this->rectangles.size(); i++) {
-				Rectangle::ID baseRectangleId = i + 1;
-				std::set<Rectangle::ID> intersectingRectangles = intersection.getIntersectingRectangles();
-
-				if (intersectingRectangles.find(baseRectangleId) != intersectingRectangles.end()) {
-					continue;
-				}
+	std::set<Canvas::RectangleIntersection> result;
+	sweepPairs(store, indices, [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		result.insert({makeShape(left, top, right, bottom), store.getId(first), store.getId(second)});
+	});
 
-				// Virtual Intersection Rectangle intersects with Actual Rectangle
-				std::optional<Rectangle> intersectionShape =
-				    Rectangle::intersection(intersection.getShape(), this->getRectangleAtIndex(i));
-				if (!intersectionShape.has_value()) {
-					continue;
-				}
+	return result;
+}
+
+std::set<Canvas::RectangleIntersection> Canvas::determinePairwiseIntersectionsParallel() const {
+	const RectangleStore &store = this->rectangles;
+
+	std::set<Canvas::RectangleIntersection> result;
+	this->forEachPairParallel([&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		result.insert({makeShape(left, top, right, bottom), store.getId(first), store.getId(second)});
+	});
+
+	return result;
+}
+
+void Canvas::forEachPairParallel(const PairCallback &callback) const {
+	// Splits the canvas into vertical strips holding about the same number of rectangles and sweeps every strip
+	// on the thread pool. A rectangle is handed to every strip it crosses, and a pair is only reported by the strip
+	// that holds the left edge of its overlap.
+	const RectangleStore &store = this->rectangles;
+
+	std::vector<int> lefts;
+	for (size_t i = 0; i < store.size(); i++) {
+		if (store.getLeft(i) < store.getRight(i) && store.getTop(i) < store.getBottom(i)) {
+			lefts.push_back(store.getLeft(i));
+		}
+	}
+	std::sort(lefts.begin(), lefts.end());
+
+	// Strip s covers [boundaries[s], boundaries[s + 1])
+	const size_t stripTarget = threadPool->getThreadCount() * STRIPS_PER_THREAD;
+	const size_t stripCount = std::max<size_t>(1, std::min(lefts.size(), stripTarget));
+	std::vector<int64_t> boundaries{std::numeric_limits<int64_t>::min()};
+	for (size_t strip = 1; strip < stripCount; strip++) {
+		boundaries.push_back(lefts[strip * lefts.size() / stripCount]);
+	}
+	boundaries.push_back(std::numeric_limits<int64_t>::max());
+
+	std::vector<std::vector<size_t>> members(stripCount);
+	for (size_t i = 0; i < store.size(); i++) {
+		if (store.getLeft(i) == store.getRight(i) || store.getTop(i) == store.getBottom(i)) {
+			continue;
+		}
+		size_t strip = std::upper_bound(boundaries.begin(), boundaries.end(), store.getLeft(i)) - boundaries.begin();
+		for (strip--; strip < stripCount && boundaries[strip] < store.getRight(i); strip++) {
+			members[strip].push_back(i);
+		}
+	}
 
-				intersectingRectangles.insert(baseRectangleId);
-				if (intersectionsFound.find(intersectingRectangles) != intersectionsFound.end()) {
-					continue;
+	struct Pair {
+			size_t first;
+			size_t second;
+			int left;
+			int top;
+			int right;
+			int bottom;
+	};
+
+	std::vector<std::vector<Pair>> found(stripCount);
+	threadPool->run(stripCount, [&](size_t strip, size_t) {
+		auto report = [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+			if (left >= boundaries[strip] && left < boundaries[strip + 1]) {
+				found[strip].push_back({first, second, left, top, right, bottom});
+			}
+		};
+		sweepPairs(store, members[strip], report);
+	});
+
+	// Strips are reported in a fixed order, so the result doesn't depend on scheduling
+	for (const std::vector<Pair> &pairs : found) {
+		for (const Pair &pair : pairs) {
+			callback(pair.first, pair.second, pair.left, pair.top, pair.right, pair.bottom);
+		}
+	}
+}
+
+std::set<Canvas::RectangleIntersection> Canvas::determinePairwiseIntersectionsGrid() const {
+	// Bins the rectangles into a uniform grid and only compares rectangles that share a cell
+	const RectangleStore &store = this->rectangles;
+	UniformGrid grid{store, this->gridCellSize};
+
+	std::set<Canvas::RectangleIntersection> result;
+	grid.forEachPair(store, [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		result.insert({makeShape(left, top, right, bottom), store.getId(first), store.getId(second)});
+	});
+
+	return result;
+}
+
+std::set<Canvas::RectangleIntersection> Canvas::determinePairwiseIntersectionsRTree() const {
+	// Packs the rectangles into an R-tree and matches every rectangle against it
+	const RectangleStore &store = this->rectangles;
+	nitro::RTree tree{store};
+
+	std::set<Canvas::RectangleIntersection> result;
+	tree.forEachPair(store, [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		result.insert({makeShape(left, top, right, bottom), store.getId(first), store.getId(second)});
+	});
+
+	return result;
+}
+
+bool Canvas::Enumeration::emit(const RectangleIntersection &intersection, size_t maxResults) {
+	if (maxResults != 0 && this->emitted == maxResults) {
+		this->limitReached = LimitReached::MaxResults;
+		return false;
+	}
+	this->emitted++;
+	if (!this->sink(intersection)) {
+		this->limitReached = LimitReached::MaxResults;
+		return false;
+	}
+	return true;
+}
+
+std::set<Canvas::RectangleIntersection>
+Canvas::determineAllIntersectionsExhaustive(const std::set<RectangleIntersection> &pairwiseIntersections) {
+	const std::vector<RectangleIntersection> result =
+	    this->collectAllIntersections(pairwiseIntersections, EnumerationStrategy::Exhaustive);
+	return {result.begin(), result.end()};
+}
+
+std::set<Canvas::RectangleIntersection>
+Canvas::determineAllIntersectionsNeighborRestricted(const std::set<RectangleIntersection> &pairwiseIntersections) {
+	const std::vector<RectangleIntersection> result =
+	    this->collectAllIntersections(pairwiseIntersections, EnumerationStrategy::NeighborRestricted);
+	return {result.begin(), result.end()};
+}
+
+std::vector<Canvas::RectangleIntersection>
+Canvas::collectAllIntersections(const std::set<RectangleIntersection> &pairwise, EnumerationStrategy strategy) {
+	// Intersections arrive in ascending order, so the result is a plain vector. They are copied out of the arenas
+	// of their level, which are released as the enumeration goes on: those copies and the growth of the result
+	// are the heap allocations left, and are counted per order.
+	std::vector<RectangleIntersection> result;
+	std::vector<LevelAllocations> heap;
+	const auto keep = [&result, &heap](const RectangleIntersection &intersection) {
+		const size_t order = intersection.getMemberCount();
+		if (heap.size() < order - 1) {
+			heap.resize(order - 1);
+		}
+		LevelAllocations &level = heap[order - 2];
+
+		const size_t capacity = result.capacity();
+		result.push_back(intersection);
+		if (result.capacity() != capacity) {
+			level.heapAllocations++;
+			level.heapBytes += result.capacity() * sizeof(RectangleIntersection);
+		}
+		// Copies of spilled IDs are allocated at their exact size
+		if (order > RectangleIntersection::INLINE_MEMBERS) {
+			level.heapAllocations++;
+			level.heapBytes += order * sizeof(Rectangle::ID);
+		}
+		return true;
+	};
+
+	Enumeration enumeration{keep, 0, 0, true};
+	for (const RectangleIntersection &intersection : pairwise) {
+		if (!enumeration.emit(intersection, this->limits.maxResults)) {
+			this->limitReached = enumeration.limitReached;
+			return result;
+		}
+		enumeration.heldBytes += footprint(intersection);
+	}
+	if (this->limits.memoryBudget != 0 && enumeration.heldBytes > this->limits.memoryBudget) {
+		this->limitReached = LimitReached::MemoryBudget;
+		return result;
+	}
+
+	this->enumerate(this->rectangles, pairwise, strategy, enumeration);
+	this->limitReached = enumeration.limitReached;
+	this->idSetStatistics = enumeration.idSetStatistics;
+	this->levelAllocations = std::move(enumeration.levelAllocations);
+	for (LevelAllocations &level : this->levelAllocations) {
+		if (level.order - 2 < heap.size()) {
+			level.heapAllocations = heap[level.order - 2].heapAllocations;
+			level.heapBytes = heap[level.order - 2].heapBytes;
+		}
+	}
+	return result;
+}
+
+void Canvas::enumerate(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+                       EnumerationStrategy strategy, Enumeration &enumeration) const {
+	switch (strategy) {
+		case EnumerationStrategy::Exhaustive:
+			this->enumerateExhaustive(store, pairwise, enumeration);
+			break;
+		case EnumerationStrategy::NeighborRestricted:
+			this->enumerateNeighborRestricted(store, pairwise, enumeration);
+			break;
+	}
+}
+
+void Canvas::enumerateExhaustive(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+                                 Enumeration &enumeration) const {
+	// Reference implementation: tries to extend every intersection with every rectangle,
+	// discarding combinations of IDs that were already found
+	std::vector<RectangleIntersection> current{pairwise.begin(), pairwise.end()};
+	size_t levelBytes = enumeration.retainsResults ? 0 : footprint(pairwise);
+	ConcurrentIdSets intersectionsFound;
+
+	for (size_t order = 2; !current.empty(); order++) {
+		// Past the maximum order, a single intersection of the next order is enough to know the limit was hit
+		const bool probing = this->limits.maxOrder != 0 && order >= this->limits.maxOrder;
+		LevelBudget budget{this->limits.memoryBudget, enumeration.heldBytes + levelBytes};
+
+		// Every level is split into chunks that are expanded on the thread pool
+		auto expand = [&](size_t begin, size_t end, std::vector<RectangleIntersection> &next) {
+			for (size_t c = begin; c < end; c++) {
+				const RectangleIntersection &intersection = current[c];
+				// All intersections are considered as virtual rectangles that can be intersected with the actual
+				// rectangles in order to form new higher-order intersections, that will be considered as virtual
+				// rectangles in the next iteration
+				for (size_t i = 0; i < store.size(); i++) {
+					Rectangle::ID baseRectangleId = store.getId(i);
+					if (intersection.contains(baseRectangleId)) {
+						continue;
+					}
+
+					// Virtual Intersection Rectangle intersects with Actual Rectangle
+					const Rectangle &shape = intersection.getShapeRef();
+					const int left = std::max(shape.getLeft(), store.getLeft(i));
+					const int top = std::max(shape.getTop(), store.getTop(i));
+					const int right = std::min(shape.getRight(), store.getRight(i));
+					const int bottom = std::min(shape.getBottom(), store.getBottom(i));
+					if (left >= right || top >= bottom) {
+						continue;
+					}
+
+					RectangleIntersection extended{makeShape(left, top, right, bottom), intersection, baseRectangleId};
+					if (!intersectionsFound.insert(extended.getMembers())) {
+						continue;
+					}
+
+					if (!budget.reserve(footprint(extended))) {
+						return;
+					}
+					next.push_back(std::move(extended));
+					if (probing) {
+						return;
+					}
 				}
-				intersectionsFound.insert(intersectingRectangles);
+			}
+		};
 
-				RectangleIntersection newIntersection{intersectionShape.value(), intersectingRectangles};
-				result.insert(newIntersection);
-				next.push_back(newIntersection);
+		std::vector<std::vector<RectangleIntersection>> found =
+		    runInChunks<RectangleIntersection>(this->threadPool.get(), current.size(), expand);
+		const bool nextLevelFound = std::any_of(found.begin(), found.end(),
+		                                        [](const std::vector<RectangleIntersection> &f) { return !f.empty(); });
+		if (probing) {
+			enumeration.limitReached = nextLevelFound ? LimitReached::MaxOrder : LimitReached::None;
+			break;
+		}
+		// A level that doesn't fit is dropped as a whole, so the receiver always gets complete orders
+		if (budget.isExceeded()) {
+			enumeration.limitReached = LimitReached::MemoryBudget;
+			break;
+		}
 
-				moreIntersectionsHappened = true;
+		// Chunks find the level in no particular order
+		std::vector<RectangleIntersection> next;
+		for (std::vector<RectangleIntersection> &level : found) {
+			std::move(level.begin(), level.end(), std::back_inserter(next));
+		}
+		std::sort(next.begin(), next.end());
+
+		levelBytes = 0;
+		const bool complete = std::all_of(next.begin(), next.end(), [&](const RectangleIntersection &intersection) {
+			if (!enumeration.emit(intersection, this->limits.maxResults)) {
+				return false;
+			}
+			if (enumeration.retainsResults) {
+				enumeration.heldBytes += footprint(intersection);
+			} else {
+				levelBytes += footprint(intersection);
 			}
+			return true;
+		});
+		if (!complete) {
+			break;
 		}
-		current = next;
+		current = std::move(next);
 	}
 
-	return result.empty() ? std::nullopt : std::make_optional(result);
+	enumeration.idSetStatistics = intersectionsFound.getStatistics();
+}
+
+void Canvas::enumerateNeighborRestricted(const RectangleStore &store, const std::set<RectangleIntersection> &pairwise,
+                                         Enumeration &enumeration) const {
+	// The pairwise intersections form an overlap graph. Axis aligned rectangles that overlap pairwise always share
+	// a common region, so every higher-order intersection is a set of rectangles that are all neighbors of each other.
+	// An intersection is only extended with the common neighbors of its members that have a larger ID than all of
+	// them, which generates every combination once, in ascending ID order, without having to look for duplicates.
+	const std::vector<std::vector<size_t>> largerNeighbors = buildLargerNeighbors(store, pairwise);
+	enumeration.heldBytes += store.size() * sizeof(std::vector<size_t>) + pairwise.size() * sizeof(size_t);
+
+	// Candidates, their spilled IDs and their extension lists live in the arena of the chunk that found them. The
+	// arenas of a level are released in one go once the level after it has been expanded.
+	struct Candidate {
+			RectangleIntersection intersection;
+			std::span<const size_t> extensions;
+	};
+	struct ChunkCandidates {
+			std::unique_ptr<Arena> arena{std::make_unique<Arena>()};
+			std::pmr::vector<Candidate> candidates{&arena->requests};
+			std::pmr::vector<size_t> scratch{&arena->requests};
+	};
+	const auto recordLevel = [&enumeration](size_t order, const std::vector<ChunkCandidates> &chunks) {
+		LevelAllocations level{order};
+		for (const ChunkCandidates &chunk : chunks) {
+			level.allocations += chunk.arena->requests.getAllocationCount();
+			level.bytes += chunk.arena->requests.getAllocatedBytes();
+			level.blocks += chunk.arena->blocks.getAllocationCount();
+		}
+		enumeration.levelAllocations.push_back(level);
+	};
+	const auto candidateBytes = [](const Candidate &candidate) {
+		return footprint(candidate.intersection) + candidate.extensions.size() * sizeof(size_t);
+	};
+
+	std::vector<ChunkCandidates> currentChunks(1);
+	ChunkCandidates &seeds = currentChunks.front();
+	size_t levelBytes = 0;
+	for (const RectangleIntersection &intersection : pairwise) {
+		const size_t index1 = store.indexOf(intersection.getRectIdAtIndex(0)).value();
+		const size_t index2 = store.indexOf(intersection.getRectIdAtIndex(1)).value();
+		std::span<const size_t> extensions =
+		    commonIndices(largerNeighbors[index1], largerNeighbors[index2], seeds.scratch, seeds.arena->requests);
+		if (!extensions.empty()) {
+			seeds.candidates.push_back({intersection, extensions});
+			levelBytes += enumeration.retainsResults ? 0 : candidateBytes(seeds.candidates.back());
+		}
+	}
+	recordLevel(2, currentChunks);
+
+	std::vector<const Candidate *> current;
+	for (const Candidate &candidate : seeds.candidates) {
+		current.push_back(&candidate);
+	}
+
+	for (size_t order = 2; !current.empty(); order++) {
+		// Only candidates that can be extended are kept, and by the common region property every one of them
+		// extends to an intersection of the next order
+		if (this->limits.maxOrder != 0 && order >= this->limits.maxOrder) {
+			enumeration.limitReached = LimitReached::MaxOrder;
+			return;
+		}
+
+		// Intersections are generated in ascending order, chunk by chunk, so no chunk needs to produce more
+		// than the number of results still missing (plus one, to tell that the limit was hit)
+		const size_t chunkCap = this->limits.maxResults != 0 ? this->limits.maxResults - enumeration.emitted + 1
+		                                                     : std::numeric_limits<size_t>::max();
+		LevelBudget budget{this->limits.memoryBudget, enumeration.heldBytes + levelBytes};
+
+		// Every level is split into chunks that are expanded on the thread pool, each into an arena of its own
+		auto expand = [&](size_t begin, size_t end, std::vector<ChunkCandidates> &output) {
+			ChunkCandidates &chunk = output.emplace_back();
+			std::pmr::vector<Candidate> &next = chunk.candidates;
+			IntersectionKernel::Block block;
+			IntersectionKernel::Block clipped;
+			for (size_t c = begin; c < end && next.size() < chunkCap; c++) {
+				const Candidate &candidate = *current[c];
+				const Rectangle &shape = candidate.intersection.getShapeRef();
+
+				// Extensions are clipped against the intersection shape one block at a time
+				for (size_t offset = 0; offset < candidate.extensions.size();
+				     offset += IntersectionKernel::BLOCK_SIZE) {
+					const size_t count = std::min(IntersectionKernel::BLOCK_SIZE, candidate.extensions.size() - offset);
+					for (size_t i = 0; i < count; i++) {
+						const size_t index = candidate.extensions[offset + i];
+						block.lefts[i] = store.getLeft(index);
+						block.tops[i] = store.getTop(index);
+						block.rights[i] = store.getRight(index);
+						block.bottoms[i] = store.getBottom(index);
+					}
+
+					const uint32_t hits =
+					    IntersectionKernel::intersect(shape.getLeft(), shape.getTop(), shape.getRight(),
+					                                  shape.getBottom(), block.lefts, block.tops, block.rights,
+					                                  block.bottoms, count, clipped);
+					for (size_t i = 0; i < count && next.size() < chunkCap; i++) {
+						if ((hits & (1u << i)) == 0) {
+							continue;
+						}
+
+						const size_t extensionIndex = candidate.extensions[offset + i];
+						Rectangle intersectionShape =
+						    makeShape(clipped.lefts[i], clipped.tops[i], clipped.rights[i], clipped.bottoms[i]);
+
+						// Kept in the next level even without extensions, so that it reaches the receiver
+						Candidate extended{{intersectionShape, candidate.intersection, store.getId(extensionIndex),
+						                    &chunk.arena->requests},
+						                   commonIndices(candidate.extensions, largerNeighbors[extensionIndex],
+						                                 chunk.scratch, chunk.arena->requests)};
+						if (!budget.reserve(candidateBytes(extended))) {
+							return;
+						}
+						next.push_back(std::move(extended));
+					}
+				}
+			}
+		};
+
+		std::vector<ChunkCandidates> found;
+		for (std::vector<ChunkCandidates> &chunk :
+		     runInChunks<ChunkCandidates>(this->threadPool.get(), current.size(), expand)) {
+			std::move(chunk.begin(), chunk.end(), std::back_inserter(found));
+		}
+		recordLevel(order + 1, found);
+		// A level that doesn't fit is dropped as a whole, so the receiver always gets complete orders
+		if (budget.isExceeded()) {
+			enumeration.limitReached = LimitReached::MemoryBudget;
+			return;
+		}
+
+		// Levels come out of the chunks in ascending order
+		std::vector<const Candidate *> next;
+		levelBytes = 0;
+		for (const ChunkCandidates &chunk : found) {
+			for (const Candidate &candidate : chunk.candidates) {
+				if (!enumeration.emit(candidate.intersection, this->limits.maxResults)) {
+					return;
+				}
+				if (enumeration.retainsResults) {
+					enumeration.heldBytes += footprint(candidate.intersection);
+				} else {
+					levelBytes += candidateBytes(candidate);
+				}
+				if (!candidate.extensions.empty()) {
+					next.push_back(&candidate);
+				}
+			}
+		}
+		current = std::move(next);
+		currentChunks = std::move(found);
+	}
 }
 
-} // namespace nitro
\ No newline at end of file
+} // namespace nitro
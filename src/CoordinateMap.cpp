@@ -0,0 +1,55 @@
+#include "CoordinateMap.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace nitro {
+
+namespace {
+
+void sortDistinct(std::vector<int64_t> &edges) {
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	if (edges.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+		throw std::length_error("Too many distinct rectangle edges to map them to 32 bit coordinates");
+	}
+}
+
+int32_t rankOf(const std::vector<int64_t> &edges, int64_t edge) {
+	return static_cast<int32_t>(std::lower_bound(edges.begin(), edges.end(), edge) - edges.begin());
+}
+
+} // namespace
+
+CoordinateMap::CoordinateMap(const std::vector<WideBox> &boxes) {
+	xs.reserve(2 * boxes.size());
+	ys.reserve(2 * boxes.size());
+	for (const WideBox &box : boxes) {
+		xs.push_back(box.left);
+		xs.push_back(box.right);
+		ys.push_back(box.top);
+		ys.push_back(box.bottom);
+	}
+	sortDistinct(xs);
+	sortDistinct(ys);
+}
+
+bool CoordinateMap::fits(const WideBox &box) {
+	const int64_t minimum = std::numeric_limits<int32_t>::min();
+	const int64_t maximum = std::numeric_limits<int32_t>::max();
+	return box.left >= minimum && box.top >= minimum && box.right <= maximum && box.bottom <= maximum;
+}
+
+Rectangle CoordinateMap::compress(Rectangle::ID id, const WideBox &box) const {
+	const int32_t left = rankOf(xs, box.left);
+	const int32_t top = rankOf(ys, box.top);
+	return Rectangle(id, {left, top}, static_cast<uint32_t>(rankOf(xs, box.right) - left),
+	                 static_cast<uint32_t>(rankOf(ys, box.bottom) - top));
+}
+
+WideBox CoordinateMap::expand(const Box &box) const {
+	return {xs[static_cast<size_t>(box.left)], ys[static_cast<size_t>(box.top)], xs[static_cast<size_t>(box.right)],
+	        ys[static_cast<size_t>(box.bottom)]};
+}
+
+} // namespace nitro
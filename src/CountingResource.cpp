@@ -0,0 +1,35 @@
+#include "CountingResource.hpp"
+
+namespace nitro {
+
+CountingResource::CountingResource(std::pmr::memory_resource *upstream) : upstream(upstream) {
+}
+
+uint64_t CountingResource::getAllocationCount() const {
+	return allocationCount;
+}
+
+uint64_t CountingResource::getAllocatedBytes() const {
+	return allocatedBytes;
+}
+
+std::pmr::memory_resource *CountingResource::getUpstream() const {
+	return upstream;
+}
+
+void *CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+	void *pointer = upstream->allocate(bytes, alignment);
+	allocationCount++;
+	allocatedBytes += bytes;
+	return pointer;
+}
+
+void CountingResource::do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) {
+	upstream->deallocate(pointer, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+	return this == &other;
+}
+
+} // namespace nitro
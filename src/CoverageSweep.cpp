@@ -0,0 +1,308 @@
+#include "CoverageSweep.hpp"
+#include <algorithm>
+
+namespace nitro {
+
+namespace {
+
+// A vertical edge of a rectangle over the elementary y intervals [low, high)
+struct CoverageEvent {
+		int x;
+		int delta;
+		size_t low;
+		size_t high;
+};
+
+// Compressed y coordinates and the events of the rectangles that have an area, sorted by x
+void buildEvents(const RectangleStore &store, std::vector<int> &ys, std::vector<CoverageEvent> &events) {
+	for (size_t i = 0; i < store.size(); i++) {
+		if (store.getLeft(i) < store.getRight(i) && store.getTop(i) < store.getBottom(i)) {
+			ys.push_back(store.getTop(i));
+			ys.push_back(store.getBottom(i));
+		}
+	}
+	std::sort(ys.begin(), ys.end());
+	ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+	for (size_t i = 0; i < store.size(); i++) {
+		if (store.getLeft(i) < store.getRight(i) && store.getTop(i) < store.getBottom(i)) {
+			const size_t low = std::lower_bound(ys.begin(), ys.end(), store.getTop(i)) - ys.begin();
+			const size_t high = std::lower_bound(ys.begin(), ys.end(), store.getBottom(i)) - ys.begin();
+			events.push_back({store.getLeft(i), 1, low, high});
+			events.push_back({store.getRight(i), -1, low, high});
+		}
+	}
+	std::sort(events.begin(), events.end(),
+	          [](const CoverageEvent &a, const CoverageEvent &b) { return a.x < b.x; });
+}
+
+// Segment tree over the elementary y intervals that tracks the minimum and maximum depth. Range additions are kept in
+// the node they cover and never pushed down, so a node's extremes only count the additions made at or below it.
+class DepthTree {
+	public:
+		explicit DepthTree(size_t leaves)
+		    : leaves{leaves}, added(4 * leaves, 0), minimum(4 * leaves, 0), maximum(4 * leaves, 0) {}
+
+		void add(size_t low, size_t high, int delta) {
+			add(1, 0, leaves, low, high, delta);
+		}
+
+		int getMax() const {
+			return maximum[1];
+		}
+
+		// Appends the maximal runs of elementary intervals [low, high) at depth target
+		void collect(int target, std::vector<std::pair<size_t, size_t>> &runs) const {
+			collect(1, 0, leaves, target, runs);
+		}
+
+		// Calls visit(depth, low, high) for the largest subtrees of elementary intervals [low, high) whose depth is
+		// the same throughout, in ascending order
+		template <typename Visit> void forEachDepth(Visit &&visit) const {
+			forEachDepth(1, 0, leaves, 0, visit);
+		}
+
+	private:
+		void add(size_t node, size_t begin, size_t end, size_t low, size_t high, int delta) {
+			if (high <= begin || end <= low) {
+				return;
+			}
+			if (low <= begin && end <= high) {
+				added[node] += delta;
+				minimum[node] += delta;
+				maximum[node] += delta;
+				return;
+			}
+			const size_t middle = (begin + end) / 2;
+			add(2 * node, begin, middle, low, high, delta);
+			add(2 * node + 1, middle, end, low, high, delta);
+			minimum[node] = added[node] + std::min(minimum[2 * node], minimum[2 * node + 1]);
+			maximum[node] = added[node] + std::max(maximum[2 * node], maximum[2 * node + 1]);
+		}
+
+		void collect(size_t node, size_t begin, size_t end, int target,
+		             std::vector<std::pair<size_t, size_t>> &runs) const {
+			if (maximum[node] != target) {
+				return;
+			}
+			if (end - begin == 1) {
+				if (!runs.empty() && runs.back().second == begin) {
+					runs.back().second = end;
+				} else {
+					runs.push_back({begin, end});
+				}
+				return;
+			}
+			const size_t middle = (begin + end) / 2;
+			collect(2 * node, begin, middle, target - added[node], runs);
+			collect(2 * node + 1, middle, end, target - added[node], runs);
+		}
+
+		template <typename Visit>
+		void forEachDepth(size_t node, size_t begin, size_t end, int above, Visit &visit) const {
+			if (minimum[node] == maximum[node]) {
+				visit(above + maximum[node], begin, end);
+				return;
+			}
+			const size_t middle = (begin + end) / 2;
+			forEachDepth(2 * node, begin, middle, above + added[node], visit);
+			forEachDepth(2 * node + 1, middle, end, above + added[node], visit);
+		}
+
+		size_t leaves;
+		std::vector<int> added;
+		std::vector<int> minimum;
+		std::vector<int> maximum;
+};
+
+// Segment tree over the elementary y intervals that keeps, for the additions made at or below every node, the length
+// covered at least once, the summed depth and the summed number of overlapping pairs over its range.
+// A point at depth d holds d * (d - 1) / 2 pairs; adding c on top of it gives that plus c * d + c * (c - 1) / 2.
+class StatisticsTree {
+	public:
+		explicit StatisticsTree(const std::vector<int> &ys)
+		    : ys{ys}, leaves{ys.size() - 1}, cover(4 * leaves, 0), covered(4 * leaves, 0), depth(4 * leaves, 0),
+		      pairs(4 * leaves, 0) {}
+
+		void add(size_t low, size_t high, int delta) {
+			add(1, 0, leaves, low, high, delta);
+		}
+
+		uint64_t getCovered() const {
+			return covered[1];
+		}
+
+		uint64_t getPairs() const {
+			return pairs[1];
+		}
+
+	private:
+		void add(size_t node, size_t begin, size_t end, size_t low, size_t high, int delta) {
+			if (high <= begin || end <= low) {
+				return;
+			}
+			if (low <= begin && end <= high) {
+				cover[node] += delta;
+			} else {
+				const size_t middle = (begin + end) / 2;
+				add(2 * node, begin, middle, low, high, delta);
+				add(2 * node + 1, middle, end, low, high, delta);
+			}
+			update(node, begin, end);
+		}
+
+		void update(size_t node, size_t begin, size_t end) {
+			const uint64_t length = static_cast<uint64_t>(static_cast<int64_t>(ys[end]) - ys[begin]);
+			const uint64_t own = static_cast<uint64_t>(cover[node]);
+			uint64_t childCovered = 0;
+			uint64_t childDepth = 0;
+			uint64_t childPairs = 0;
+			if (end - begin > 1) {
+				childCovered = covered[2 * node] + covered[2 * node + 1];
+				childDepth = depth[2 * node] + depth[2 * node + 1];
+				childPairs = pairs[2 * node] + pairs[2 * node + 1];
+			}
+
+			covered[node] = own > 0 ? length : childCovered;
+			depth[node] = childDepth + own * length;
+			pairs[node] = childPairs + own * childDepth + own * (own - 1) / 2 * length;
+		}
+
+		const std::vector<int> &ys;
+		size_t leaves;
+		std::vector<int> cover;
+		std::vector<uint64_t> covered;
+		std::vector<uint64_t> depth;
+		std::vector<uint64_t> pairs;
+};
+
+} // namespace
+
+CoverageSweep::CoverageSweep(const RectangleStore &store) {
+	std::vector<int> ys;
+	std::vector<CoverageEvent> events;
+	buildEvents(store, ys, events);
+	if (events.empty()) {
+		return;
+	}
+
+	// Regions are extended to the right while the next slab has the same runs at maximum depth
+	DepthTree tree{ys.size() - 1};
+	std::vector<std::pair<size_t, size_t>> runs;
+	std::vector<size_t> previousSlab;
+	std::vector<size_t> currentSlab;
+	for (size_t e = 0; e < events.size();) {
+		const int x = events[e].x;
+		for (; e < events.size() && events[e].x == x; e++) {
+			tree.add(events[e].low, events[e].high, events[e].delta);
+		}
+		if (e == events.size()) {
+			break;
+		}
+
+		const int nextX = events[e].x;
+		const int depth = tree.getMax();
+		if (depth <= 0 || static_cast<size_t>(depth) < this->maxDepth) {
+			previousSlab.clear();
+			continue;
+		}
+		if (static_cast<size_t>(depth) > this->maxDepth) {
+			this->maxDepth = static_cast<size_t>(depth);
+			this->maxDepthRegions.clear();
+			previousSlab.clear();
+		}
+
+		runs.clear();
+		tree.collect(depth, runs);
+		currentSlab.clear();
+		size_t previous = 0;
+		for (const auto &[low, high] : runs) {
+			while (previous < previousSlab.size() && maxDepthRegions[previousSlab[previous]].top < ys[low]) {
+				previous++;
+			}
+			if (previous < previousSlab.size()) {
+				Region &region = maxDepthRegions[previousSlab[previous]];
+				if (region.top == ys[low] && region.bottom == ys[high] && region.right == x) {
+					region.right = nextX;
+					currentSlab.push_back(previousSlab[previous]);
+					continue;
+				}
+			}
+			maxDepthRegions.push_back({x, ys[low], nextX, ys[high]});
+			currentSlab.push_back(maxDepthRegions.size() - 1);
+		}
+		std::swap(previousSlab, currentSlab);
+	}
+}
+
+size_t CoverageSweep::getMaxDepth() const {
+	return maxDepth;
+}
+
+const std::vector<CoverageSweep::Region> &CoverageSweep::getMaxDepthRegions() const {
+	return maxDepthRegions;
+}
+
+std::vector<uint64_t> CoverageSweep::computeAreaByDepth(const RectangleStore &store) const {
+	std::vector<uint64_t> areas(this->maxDepth + 1, 0);
+	std::vector<int> ys;
+	std::vector<CoverageEvent> events;
+	buildEvents(store, ys, events);
+	if (events.empty()) {
+		return areas;
+	}
+
+	// Every slab adds its width times the length of each stretch of uniform depth to the area of that depth
+	DepthTree tree{ys.size() - 1};
+	for (size_t e = 0; e < events.size();) {
+		const int x = events[e].x;
+		for (; e < events.size() && events[e].x == x; e++) {
+			tree.add(events[e].low, events[e].high, events[e].delta);
+		}
+		if (e == events.size()) {
+			break;
+		}
+
+		const uint64_t width = static_cast<uint64_t>(static_cast<int64_t>(events[e].x) - x);
+		tree.forEachDepth([&](int depth, size_t low, size_t high) {
+			if (depth > 0) {
+				const int64_t length = static_cast<int64_t>(ys[high]) - ys[low];
+				areas[static_cast<size_t>(depth)] += width * static_cast<uint64_t>(length);
+			}
+		});
+	}
+
+	return areas;
+}
+
+CoverageSweep::Statistics CoverageSweep::computeStatistics(const RectangleStore &store) {
+	Statistics statistics;
+	std::vector<int> ys;
+	std::vector<CoverageEvent> events;
+	buildEvents(store, ys, events);
+	if (events.empty()) {
+		return statistics;
+	}
+
+	// Events are sorted by x and ys are sorted, so the first and last of each span the covered area
+	statistics.boundingBox = Region{events.front().x, ys.front(), events.back().x, ys.back()};
+
+	StatisticsTree tree{ys};
+	for (size_t e = 0; e < events.size();) {
+		const int x = events[e].x;
+		for (; e < events.size() && events[e].x == x; e++) {
+			tree.add(events[e].low, events[e].high, events[e].delta);
+		}
+		if (e == events.size()) {
+			break;
+		}
+
+		const uint64_t width = static_cast<uint64_t>(static_cast<int64_t>(events[e].x) - x);
+		statistics.unionArea += width * tree.getCovered();
+		statistics.overlapArea += width * tree.getPairs();
+	}
+
+	return statistics;
+}
+
+} // namespace nitro
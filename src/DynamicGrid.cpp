@@ -0,0 +1,142 @@
+#include "DynamicGrid.hpp"
+#include <algorithm>
+
+namespace nitro {
+
+namespace {
+
+// Removes one occurrence of id from an unordered list
+void removeId(std::vector<Rectangle::ID> &ids, Rectangle::ID id) {
+	auto it = std::find(ids.begin(), ids.end(), id);
+	if (it != ids.end()) {
+		*it = ids.back();
+		ids.pop_back();
+	}
+}
+
+} // namespace
+
+DynamicGrid::DynamicGrid(const RectangleStore &store, int64_t cellSize) {
+	if (cellSize <= AUTOMATIC_CELL_SIZE && !store.empty()) {
+		int64_t extentSum = 0;
+		for (size_t i = 0; i < store.size(); i++) {
+			const int64_t width = static_cast<int64_t>(store.getRight(i)) - store.getLeft(i);
+			const int64_t height = static_cast<int64_t>(store.getBottom(i)) - store.getTop(i);
+			extentSum += (width + height) / 2;
+		}
+		cellSize = extentSum / static_cast<int64_t>(store.size());
+	}
+	this->cellSize = cellSize > 0 ? cellSize : DEFAULT_CELL_SIZE;
+
+	for (size_t i = 0; i < store.size(); i++) {
+		insert(store.getId(i), store.getLeft(i), store.getTop(i), store.getRight(i), store.getBottom(i));
+	}
+}
+
+int64_t DynamicGrid::getCellSize() const {
+	return cellSize;
+}
+
+size_t DynamicGrid::getCellCount() const {
+	return cells.size();
+}
+
+int64_t DynamicGrid::cellOf(int coordinate) const {
+	// Rounds towards negative infinity, so negative coordinates get cells of their own
+	const int64_t value = coordinate;
+	return value >= 0 ? value / cellSize : -((-value + cellSize - 1) / cellSize);
+}
+
+uint64_t DynamicGrid::keyOf(int64_t column, int64_t row) {
+	return (static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32) | static_cast<uint32_t>(row);
+}
+
+void DynamicGrid::insert(Rectangle::ID id, int left, int top, int right, int bottom) {
+	const int64_t firstColumn = cellOf(left);
+	const int64_t lastColumn = cellOf(right);
+	const int64_t firstRow = cellOf(top);
+	const int64_t lastRow = cellOf(bottom);
+	if (static_cast<uint64_t>(lastColumn - firstColumn + 1) * static_cast<uint64_t>(lastRow - firstRow + 1) >
+	    MAX_CELLS_PER_RECTANGLE) {
+		oversized.push_back(id);
+		return;
+	}
+
+	for (int64_t row = firstRow; row <= lastRow; row++) {
+		for (int64_t column = firstColumn; column <= lastColumn; column++) {
+			cells[keyOf(column, row)].push_back(id);
+		}
+	}
+}
+
+void DynamicGrid::erase(Rectangle::ID id, int left, int top, int right, int bottom) {
+	// The edges must be the ones the rectangle was inserted with
+	const int64_t firstColumn = cellOf(left);
+	const int64_t lastColumn = cellOf(right);
+	const int64_t firstRow = cellOf(top);
+	const int64_t lastRow = cellOf(bottom);
+	if (static_cast<uint64_t>(lastColumn - firstColumn + 1) * static_cast<uint64_t>(lastRow - firstRow + 1) >
+	    MAX_CELLS_PER_RECTANGLE) {
+		removeId(oversized, id);
+		return;
+	}
+
+	for (int64_t row = firstRow; row <= lastRow; row++) {
+		for (int64_t column = firstColumn; column <= lastColumn; column++) {
+			auto cell = cells.find(keyOf(column, row));
+			if (cell == cells.end()) {
+				continue;
+			}
+			removeId(cell->second, id);
+			if (cell->second.empty()) {
+				cells.erase(cell);
+			}
+		}
+	}
+}
+
+std::vector<size_t> DynamicGrid::queryWindow(const RectangleStore &store, int left, int top, int right,
+                                             int bottom) const {
+	std::vector<size_t> result;
+	auto consider = [&](Rectangle::ID id) {
+		const size_t index = store.indexOf(id).value();
+		if (store.getLeft(index) <= right && left <= store.getRight(index) && store.getTop(index) <= bottom &&
+		    top <= store.getBottom(index)) {
+			result.push_back(index);
+		}
+	};
+
+	const int64_t firstColumn = cellOf(left);
+	const int64_t lastColumn = cellOf(right);
+	const int64_t firstRow = cellOf(top);
+	const int64_t lastRow = cellOf(bottom);
+	const uint64_t windowCells =
+	    static_cast<uint64_t>(lastColumn - firstColumn + 1) * static_cast<uint64_t>(lastRow - firstRow + 1);
+	if (windowCells <= cells.size()) {
+		for (int64_t row = firstRow; row <= lastRow; row++) {
+			for (int64_t column = firstColumn; column <= lastColumn; column++) {
+				auto cell = cells.find(keyOf(column, row));
+				if (cell != cells.end()) {
+					std::for_each(cell->second.begin(), cell->second.end(), consider);
+				}
+			}
+		}
+	} else {
+		// A window larger than the occupied part of the grid visits the occupied cells instead
+		for (const auto &[key, ids] : cells) {
+			const int64_t column = static_cast<int32_t>(key >> 32);
+			const int64_t row = static_cast<int32_t>(key & 0xFFFFFFFFu);
+			if (firstColumn <= column && column <= lastColumn && firstRow <= row && row <= lastRow) {
+				std::for_each(ids.begin(), ids.end(), consider);
+			}
+		}
+	}
+	std::for_each(oversized.begin(), oversized.end(), consider);
+
+	// A rectangle covering several cells of the window is found once per cell
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+} // namespace nitro
@@ -0,0 +1,139 @@
+#include "IdSetTable.hpp"
+#include <algorithm>
+
+namespace nitro {
+
+namespace {
+
+// Finalizer of SplitMix64, spreads every input bit over the whole word
+uint64_t mix(uint64_t value) {
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+} // namespace
+
+size_t IdSetTable::size() const {
+	return entries;
+}
+
+bool IdSetTable::empty() const {
+	return entries == 0;
+}
+
+size_t IdSetTable::getCapacity() const {
+	return slots.size();
+}
+
+double IdSetTable::getLoadFactor() const {
+	return slots.empty() ? 0.0 : static_cast<double>(entries) / static_cast<double>(slots.size());
+}
+
+uint64_t IdSetTable::getLookupCount() const {
+	return lookups;
+}
+
+double IdSetTable::getAverageProbeLength() const {
+	return lookups == 0 ? 0.0 : static_cast<double>(probes) / static_cast<double>(lookups);
+}
+
+size_t IdSetTable::getMaxProbeLength() const {
+	return maxProbeLength;
+}
+
+uint64_t IdSetTable::getCollisionCount() const {
+	return collisions;
+}
+
+uint64_t IdSetTable::fingerprint(std::span<const Rectangle::ID> ids) {
+	uint64_t hash = mix(ids.size());
+	for (Rectangle::ID id : ids) {
+		hash = mix(hash ^ (id + 0x9E3779B97F4A7C15ull));
+	}
+	return hash;
+}
+
+bool IdSetTable::insert(std::span<const Rectangle::ID> ids) {
+	return this->insert(ids, fingerprint(ids));
+}
+
+bool IdSetTable::insert(std::span<const Rectangle::ID> ids, uint64_t fingerprint) {
+	if (slots.empty() || (entries + 1) * 100 > slots.size() * MAX_LOAD_PERCENT) {
+		this->grow();
+	}
+
+	Slot &slot = slots[this->findSlot(ids, fingerprint)];
+	if (slot.occupied) {
+		return false;
+	}
+
+	slot = {fingerprint, arena.size(), static_cast<uint32_t>(ids.size()), true};
+	arena.insert(arena.end(), ids.begin(), ids.end());
+	entries++;
+	return true;
+}
+
+bool IdSetTable::contains(std::span<const Rectangle::ID> ids) const {
+	if (slots.empty()) {
+		return false;
+	}
+	return slots[this->findSlot(ids, fingerprint(ids))].occupied;
+}
+
+void IdSetTable::clear() {
+	slots.clear();
+	arena.clear();
+	entries = 0;
+	lookups = 0;
+	probes = 0;
+	maxProbeLength = 0;
+	collisions = 0;
+}
+
+size_t IdSetTable::findSlot(std::span<const Rectangle::ID> ids, uint64_t fingerprint) const {
+	// The capacity is a power of two, so the low bits of the fingerprint pick the first slot
+	const size_t mask = slots.size() - 1;
+	size_t index = fingerprint & mask;
+	size_t probeLength = 1;
+	while (true) {
+		const Slot &slot = slots[index];
+		if (!slot.occupied) {
+			break;
+		}
+		if (slot.fingerprint == fingerprint) {
+			const Rectangle::ID *stored = arena.data() + slot.offset;
+			if (slot.count == ids.size() && std::equal(ids.begin(), ids.end(), stored)) {
+				break;
+			}
+			collisions++;
+		}
+		index = (index + 1) & mask;
+		probeLength++;
+	}
+
+	lookups++;
+	probes += probeLength;
+	maxProbeLength = std::max(maxProbeLength, probeLength);
+	return index;
+}
+
+void IdSetTable::grow() {
+	// Stored fingerprints are reused, the ID lists stay where they are in the arena
+	std::vector<Slot> previous = std::move(slots);
+	slots.assign(previous.empty() ? INITIAL_CAPACITY : previous.size() * 2, Slot{});
+
+	const size_t mask = slots.size() - 1;
+	for (const Slot &slot : previous) {
+		if (!slot.occupied) {
+			continue;
+		}
+		size_t index = slot.fingerprint & mask;
+		while (slots[index].occupied) {
+			index = (index + 1) & mask;
+		}
+		slots[index] = slot;
+	}
+}
+
+} // namespace nitro
@@ -0,0 +1,159 @@
+#include "IntersectionKernel.hpp"
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NITRO_KERNEL_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace nitro {
+
+namespace {
+
+using Implementation = uint32_t (*)(int left, int top, int right, int bottom, const int *lefts, const int *tops,
+                                    const int *rights, const int *bottoms, size_t count,
+                                    IntersectionKernel::Block &clipped);
+
+#ifdef NITRO_KERNEL_DISPATCH
+
+// Only these functions are compiled for AVX2 and SSE4.1, and they only run when the processor supports them
+
+__attribute__((target("avx2"))) uint32_t intersectAvx2(int left, int top, int right, int bottom, const int *lefts,
+                                                       const int *tops, const int *rights, const int *bottoms,
+                                                       size_t count, IntersectionKernel::Block &clipped) {
+	// Lanes past count are neither loaded nor reported
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i loadMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), lanes);
+
+	const __m256i l = _mm256_max_epi32(_mm256_set1_epi32(left), _mm256_maskload_epi32(lefts, loadMask));
+	const __m256i t = _mm256_max_epi32(_mm256_set1_epi32(top), _mm256_maskload_epi32(tops, loadMask));
+	const __m256i r = _mm256_min_epi32(_mm256_set1_epi32(right), _mm256_maskload_epi32(rights, loadMask));
+	const __m256i b = _mm256_min_epi32(_mm256_set1_epi32(bottom), _mm256_maskload_epi32(bottoms, loadMask));
+
+	_mm256_store_si256(reinterpret_cast<__m256i *>(clipped.lefts), l);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(clipped.tops), t);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(clipped.rights), r);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(clipped.bottoms), b);
+
+	const __m256i hits = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(r, l), _mm256_cmpgt_epi32(b, t)),
+	                                      loadMask);
+	return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hits)));
+}
+
+__attribute__((target("sse4.1"))) uint32_t intersectSse41(int left, int top, int right, int bottom, const int *lefts,
+                                                          const int *tops, const int *rights, const int *bottoms,
+                                                          size_t count, IntersectionKernel::Block &clipped) {
+	const __m128i boxLeft = _mm_set1_epi32(left);
+	const __m128i boxTop = _mm_set1_epi32(top);
+	const __m128i boxRight = _mm_set1_epi32(right);
+	const __m128i boxBottom = _mm_set1_epi32(bottom);
+
+	uint32_t mask = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i l = _mm_max_epi32(boxLeft, _mm_loadu_si128(reinterpret_cast<const __m128i *>(lefts + i)));
+		const __m128i t = _mm_max_epi32(boxTop, _mm_loadu_si128(reinterpret_cast<const __m128i *>(tops + i)));
+		const __m128i r = _mm_min_epi32(boxRight, _mm_loadu_si128(reinterpret_cast<const __m128i *>(rights + i)));
+		const __m128i b = _mm_min_epi32(boxBottom, _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottoms + i)));
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(clipped.lefts + i), l);
+		_mm_store_si128(reinterpret_cast<__m128i *>(clipped.tops + i), t);
+		_mm_store_si128(reinterpret_cast<__m128i *>(clipped.rights + i), r);
+		_mm_store_si128(reinterpret_cast<__m128i *>(clipped.bottoms + i), b);
+
+		const __m128i hits = _mm_and_si128(_mm_cmpgt_epi32(r, l), _mm_cmpgt_epi32(b, t));
+		mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(hits))) << i;
+	}
+
+	// Remaining candidates of a partial block
+	for (; i < count; i++) {
+		clipped.lefts[i] = std::max(left, lefts[i]);
+		clipped.tops[i] = std::max(top, tops[i]);
+		clipped.rights[i] = std::min(right, rights[i]);
+		clipped.bottoms[i] = std::min(bottom, bottoms[i]);
+
+		const bool hit = clipped.lefts[i] < clipped.rights[i] && clipped.tops[i] < clipped.bottoms[i];
+		mask |= static_cast<uint32_t>(hit) << i;
+	}
+	return mask;
+}
+
+#endif
+
+IntersectionKernel::InstructionSet detectInstructionSet() {
+#ifdef NITRO_KERNEL_DISPATCH
+	// Needed when the detection runs before the constructors of the runtime library
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return IntersectionKernel::InstructionSet::AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.1")) {
+		return IntersectionKernel::InstructionSet::SSE41;
+	}
+#endif
+	return IntersectionKernel::InstructionSet::Scalar;
+}
+
+Implementation implementationOf(IntersectionKernel::InstructionSet instructionSet) {
+	switch (instructionSet) {
+#ifdef NITRO_KERNEL_DISPATCH
+		case IntersectionKernel::InstructionSet::AVX2:
+			return intersectAvx2;
+		case IntersectionKernel::InstructionSet::SSE41:
+			return intersectSse41;
+#endif
+		default:
+			return IntersectionKernel::intersectScalar;
+	}
+}
+
+// Picked once, when the program starts
+const IntersectionKernel::InstructionSet detected = detectInstructionSet();
+const Implementation selected = implementationOf(detected);
+
+} // namespace
+
+uint32_t IntersectionKernel::intersect(int left, int top, int right, int bottom, const int *lefts, const int *tops,
+                                       const int *rights, const int *bottoms, size_t count, Block &clipped) {
+	return selected(left, top, right, bottom, lefts, tops, rights, bottoms, count, clipped);
+}
+
+uint32_t IntersectionKernel::intersectScalar(int left, int top, int right, int bottom, const int *lefts,
+                                             const int *tops, const int *rights, const int *bottoms, size_t count,
+                                             Block &clipped) {
+	uint32_t mask = 0;
+	for (size_t i = 0; i < count; i++) {
+		clipped.lefts[i] = std::max(left, lefts[i]);
+		clipped.tops[i] = std::max(top, tops[i]);
+		clipped.rights[i] = std::min(right, rights[i]);
+		clipped.bottoms[i] = std::min(bottom, bottoms[i]);
+
+		const bool hit = clipped.lefts[i] < clipped.rights[i] && clipped.tops[i] < clipped.bottoms[i];
+		mask |= static_cast<uint32_t>(hit) << i;
+	}
+	return mask;
+}
+
+uint32_t IntersectionKernel::intersectWith(InstructionSet instructionSet, int left, int top, int right, int bottom,
+                                           const int *lefts, const int *tops, const int *rights, const int *bottoms,
+                                           size_t count, Block &clipped) {
+	return implementationOf(instructionSet)(left, top, right, bottom, lefts, tops, rights, bottoms, count, clipped);
+}
+
+bool IntersectionKernel::isSupported(InstructionSet instructionSet) {
+	// Every processor with AVX2 also has SSE4.1
+	return instructionSet <= detected;
+}
+
+const char *IntersectionKernel::getInstructionSet() {
+	switch (detected) {
+		case InstructionSet::AVX2:
+			return "AVX2";
+		case InstructionSet::SSE41:
+			return "SSE4.1";
+		default:
+			return "Scalar";
+	}
+}
+
+} // namespace nitro
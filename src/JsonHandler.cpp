@@ -6,6 +6,212 @@ namespace nitro {
 
 using json = nlohmann::json;
 
+namespace {
+
+// Rectangles are kept in 32 bit coordinates. Larger values are rejected instead of being narrowed, which would
+// silently move the rectangle.
+int checkedCoordinate(int64_t value) {
+	if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+		throw std::runtime_error("Rectangle coordinates exceed the supported range: " + std::to_string(value));
+	}
+	return static_cast<int>(value);
+}
+
+// Coordinates of 64 bit boxes, for input beyond the 32 bit range
+int64_t wideCoordinate(const json &value) {
+	const uint64_t maxInteger = std::numeric_limits<int64_t>::max();
+	if (value.is_number_unsigned() && value.get<uint64_t>() > maxInteger) {
+		throw std::runtime_error("Rectangle coordinates exceed the supported range: " +
+		                         std::to_string(value.get<uint64_t>()));
+	}
+	return value.get<int64_t>();
+}
+
+int checkedCoordinate(const json &value) {
+	if (value.is_number_unsigned()) {
+		const uint64_t maxInteger = std::numeric_limits<int64_t>::max();
+		return checkedCoordinate(static_cast<int64_t>(std::min(value.get<uint64_t>(), maxInteger)));
+	}
+	return checkedCoordinate(value.get<int64_t>());
+}
+
+// SAX handler that picks the rectangles out of one array of the root object as the parser goes through the file.
+// Rectangles are validated like unmarshal() does, and the parse is stopped once maxSize rectangles were visited.
+class RectangleReader : public nlohmann::json_sax<json> {
+	public:
+		RectangleReader(const std::string &filePath, const std::string &key, size_t maxSize,
+		                const JsonHandler::RectangleVisitor &visit)
+		    : filePath(filePath), arrayKey(key), maxSize(maxSize), visit(visit) {
+		}
+
+		bool found() const {
+			return state != State::Searching;
+		}
+
+		size_t getCount() const {
+			return count;
+		}
+
+		bool null() override {
+			return scalar();
+		}
+
+		bool boolean(bool) override {
+			return scalar();
+		}
+
+		bool number_integer(number_integer_t value) override {
+			return integer(value);
+		}
+
+		bool number_unsigned(number_unsigned_t value) override {
+			const number_unsigned_t maxInteger = std::numeric_limits<number_integer_t>::max();
+			return integer(static_cast<number_integer_t>(std::min(value, maxInteger)));
+		}
+
+		bool number_float(number_float_t, const string_t &) override {
+			return scalar();
+		}
+
+		bool string(string_t &) override {
+			return scalar();
+		}
+
+		bool binary(binary_t &) override {
+			return scalar();
+		}
+
+		bool start_object(std::size_t) override {
+			containerStart();
+			if (state == State::InArray && depth == ARRAY_DEPTH) {
+				fields = {};
+			}
+			depth++;
+			return true;
+		}
+
+		bool key(string_t &value) override {
+			if (depth == ROOT_DEPTH && state == State::Searching && value == arrayKey) {
+				state = State::Expecting;
+			} else if (state == State::InArray && depth == RECTANGLE_DEPTH) {
+				field = value;
+			}
+			return true;
+		}
+
+		bool end_object() override {
+			depth--;
+			if (state != State::InArray || depth != ARRAY_DEPTH) {
+				return true;
+			}
+
+			if (!fields.x || !fields.y || !fields.w || !fields.h) {
+				throw std::runtime_error("JSON Object does not define a rectangle");
+			}
+			if (fields.w.value() < 0 || fields.h.value() < 0) {
+				throw std::runtime_error("Rectangle width and height must be non-negative");
+			}
+			if (fields.w.value() == 0 && fields.h.value() == 0) {
+				throw std::runtime_error("Rectangle cannot be a point (width and height both zero)");
+			}
+
+			visit(Rectangle(static_cast<Rectangle::ID>(++count), {fields.x.value(), fields.y.value()},
+			                static_cast<uint32_t>(fields.w.value()), static_cast<uint32_t>(fields.h.value())));
+			// Returning false stops the parser
+			return count < maxSize;
+		}
+
+		bool start_array(std::size_t) override {
+			if (state == State::Expecting && depth == ROOT_DEPTH) {
+				state = State::InArray;
+				depth++;
+				return maxSize > 0;
+			}
+			containerStart();
+			depth++;
+			return true;
+		}
+
+		bool end_array() override {
+			depth--;
+			if (state == State::InArray && depth == ROOT_DEPTH) {
+				state = State::Done;
+			}
+			return true;
+		}
+
+		bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &e) override {
+			throw std::runtime_error("Could not parse JSON at  " + filePath + ": " + e.what());
+		}
+
+	private:
+		enum class State {
+			Searching,
+			Expecting,
+			InArray,
+			Done
+		};
+
+		struct Fields {
+				std::optional<int> x;
+				std::optional<int> y;
+				std::optional<int> w;
+				std::optional<int> h;
+		};
+
+		static const size_t ROOT_DEPTH = 1;
+		static const size_t ARRAY_DEPTH = 2;
+		static const size_t RECTANGLE_DEPTH = 3;
+
+		// Called for every value that is not a container
+		bool scalar() {
+			if (state == State::Expecting && depth == ROOT_DEPTH) {
+				throw std::runtime_error("JSON Object at key [" + arrayKey + "] is not an array");
+			}
+			if (state == State::InArray && depth == ARRAY_DEPTH) {
+				throw std::runtime_error("JSON Object does not define a rectangle");
+			}
+			return true;
+		}
+
+		void containerStart() {
+			if (state == State::Expecting && depth == ROOT_DEPTH) {
+				throw std::runtime_error("JSON Object at key [" + arrayKey + "] is not an array");
+			}
+		}
+
+		bool integer(number_integer_t value) {
+			scalar();
+			if (state != State::InArray || depth != RECTANGLE_DEPTH) {
+				return true;
+			}
+
+			if (field == "x") {
+				fields.x = checkedCoordinate(value);
+			} else if (field == "y") {
+				fields.y = checkedCoordinate(value);
+			} else if (field == "w") {
+				fields.w = checkedCoordinate(value);
+			} else if (field == "h") {
+				fields.h = checkedCoordinate(value);
+			}
+			return true;
+		}
+
+		const std::string &filePath;
+		const std::string &arrayKey;
+		size_t maxSize;
+		const JsonHandler::RectangleVisitor &visit;
+
+		State state{State::Searching};
+		size_t depth{0};
+		size_t count{0};
+		std::string field;
+		Fields fields;
+};
+
+} // namespace
+
 JsonHandler::JsonHandler() {
 }
 
@@ -19,7 +225,23 @@ bool JsonHandler::valid() const {
 
 bool JsonHandler::loadFile(const std::string &filePath) {
 	this->fileValid = false;
+	std::ifstream file = openFile(filePath);
+
+	try {
+		jsonFile = json::parse(file);
+		fileValid = true;
+	} catch (const json::parse_error &e) {
+		throw std::runtime_error("Could not parse JSON at  " + filePath + ": " + e.what());
+	} catch (const std::exception &e) {
+		throw std::runtime_error("Unexpected error parsing JSON at  " + filePath + ": " + e.what());
+	}
 
+	file.close();
+	this->filePath = filePath;
+	return this->fileValid;
+}
+
+std::ifstream JsonHandler::openFile(const std::string &filePath) {
 	if (std::filesystem::is_directory(filePath)) {
 		throw std::invalid_argument("Path is a directory, not a file:  " + filePath);
 	}
@@ -38,18 +260,18 @@ bool JsonHandler::loadFile(const std::string &filePath) {
 		throw std::runtime_error("File is empty:  " + filePath);
 	}
 
-	try {
-		jsonFile = json::parse(file);
-		fileValid = true;
-	} catch (const json::parse_error &e) {
-		throw std::runtime_error("Could not parse JSON at  " + filePath + ": " + e.what());
-	} catch (const std::exception &e) {
-		throw std::runtime_error("Unexpected error parsing JSON at  " + filePath + ": " + e.what());
-	}
+	return file;
+}
 
-	file.close();
-	this->filePath = filePath;
-	return this->fileValid;
+size_t JsonHandler::streamRectangles(const std::string &filePath, const std::string &key, size_t maxSize,
+                                     const RectangleVisitor &visit) {
+	std::ifstream file = openFile(filePath);
+	RectangleReader reader{filePath, key, maxSize, visit};
+	json::sax_parse(file, &reader);
+	if (!reader.found()) {
+		throw std::runtime_error("JSON File does not contain key: " + key);
+	}
+	return reader.getCount();
 }
 
 std::string JsonHandler::getFilePath() const {
@@ -78,19 +300,19 @@ std::optional<json> JsonHandler::getArray(const std::string &key, const size_t m
 	return array.empty() ? std::nullopt : std::make_optional(array);
 }
 
-template <typename T> std::optional<T> JsonHandler::unmarshal(json j) {
+template <typename T> std::optional<T> JsonHandler::unmarshal(const json &j) {
 	// compiler won't even let it reach this throw
 	throw std::invalid_argument("Unmarshal not implemented for type");
 }
 
-template <> std::optional<Rectangle> JsonHandler::unmarshal(json j) {
+template <> std::optional<Rectangle> JsonHandler::unmarshal(const json &j) {
 	if (j.contains("x") && j["x"].is_number_integer() && j.contains("y") && j["y"].is_number_integer() &&
 	    j.contains("w") && j["w"].is_number_integer() && j.contains("h") && j["h"].is_number_integer()) {
 
-		int x = j["x"].get<int>();
-		int y = j["y"].get<int>();
-		int w = j["w"].get<int>();
-		int h = j["h"].get<int>();
+		int x = checkedCoordinate(j["x"]);
+		int y = checkedCoordinate(j["y"]);
+		int w = checkedCoordinate(j["w"]);
+		int h = checkedCoordinate(j["h"]);
 		
 		if (w < 0 || h < 0) {
 			throw std::runtime_error("Rectangle width and height must be non-negative");
@@ -109,14 +331,64 @@ template <> std::optional<Rectangle> JsonHandler::unmarshal(json j) {
 	return std::nullopt;
 }
 
-template <> std::optional<std::vector<Rectangle>> JsonHandler::unmarshal(json j) {
+template <> std::optional<WideBox> JsonHandler::unmarshal(const json &j) {
+	// Same checks as for a Rectangle, with 64 bit coordinates
+	if (j.contains("x") && j["x"].is_number_integer() && j.contains("y") && j["y"].is_number_integer() &&
+	    j.contains("w") && j["w"].is_number_integer() && j.contains("h") && j["h"].is_number_integer()) {
+
+		int64_t x = wideCoordinate(j["x"]);
+		int64_t y = wideCoordinate(j["y"]);
+		int64_t w = wideCoordinate(j["w"]);
+		int64_t h = wideCoordinate(j["h"]);
+
+		if (w < 0 || h < 0) {
+			throw std::runtime_error("Rectangle width and height must be non-negative");
+		}
+
+		if (w == 0 && h == 0) {
+			throw std::runtime_error("Rectangle cannot be a point (width and height both zero)");
+		}
+
+		const int64_t maxInteger = std::numeric_limits<int64_t>::max();
+		if (x > maxInteger - w || y > maxInteger - h) {
+			throw std::runtime_error("Rectangle coordinates exceed the supported range: " +
+			                         std::to_string(x > maxInteger - w ? x : y));
+		}
+
+		return WideBox{x, y, x + w, y + h};
+
+	} else {
+		throw std::runtime_error("JSON Object does not define a rectangle");
+	}
+
+	return std::nullopt;
+}
+
+template <> std::optional<std::vector<WideBox>> JsonHandler::unmarshal(const json &j) {
+	if (!j.is_array()) {
+		throw std::runtime_error("JSON Object is not an array");
+	}
+
+	// Boxes carry no ID, the rectangle at index i has ID i + 1 as in unmarshal<std::vector<Rectangle>>()
+	std::vector<WideBox> boxes;
+	for (const json &jsonObject : j) {
+		std::optional<WideBox> box = unmarshal<WideBox>(jsonObject);
+		if (box.has_value()) {
+			boxes.push_back(box.value());
+		}
+	}
+
+	return boxes.empty() ? std::nullopt : std::make_optional(std::move(boxes));
+}
+
+template <> std::optional<std::vector<Rectangle>> JsonHandler::unmarshal(const json &j) {
 	if (!j.is_array()) {
 		throw std::runtime_error("JSON Object is not an array");
 	}
 
 	std::vector<Rectangle> rects;
 	Rectangle::ID id = 1;
-	for (auto jsonObject : j) {
+	for (const json &jsonObject : j) {
 		std::optional<Rectangle> r = unmarshal<Rectangle>(jsonObject);
 		if (r.has_value()) {
 			Rectangle rect = r.value();
@@ -125,7 +397,7 @@ template <> std::optional<std::vector<Rectangle>> JsonHandler::unmarshal(json j)
 		}
 	}
 
-	return rects.empty() ? std::nullopt : std::make_optional(rects);
+	return rects.empty() ? std::nullopt : std::make_optional(std::move(rects));
 }
 
 } // namespace nitro
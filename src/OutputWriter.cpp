@@ -0,0 +1,84 @@
+#include "OutputWriter.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace nitro {
+
+OutputWriter::OutputWriter(std::ostream &stream, size_t bufferSize)
+    : stream(stream), buffer(std::max(bufferSize, MAX_NUMBER_LENGTH)) {
+}
+
+OutputWriter::~OutputWriter() {
+	flush();
+}
+
+OutputWriter &OutputWriter::operator<<(std::string_view text) {
+	if (text.size() > buffer.size()) {
+		// Too large to be buffered, written straight through
+		flush();
+		stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+		return *this;
+	}
+
+	reserve(text.size());
+	std::memcpy(buffer.data() + used, text.data(), text.size());
+	used += text.size();
+	return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(char character) {
+	reserve(1);
+	buffer[used++] = character;
+	return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(const Rectangle &rectangle) {
+	const WideBox box = inputBox(rectangle);
+	return *this << rectangle.getId() << ": Rectangle at (" << box.left << ',' << box.top
+	             << "), w=" << box.right - box.left << ", h=" << box.bottom - box.top;
+}
+
+OutputWriter &OutputWriter::operator<<(const Canvas::RectangleIntersection &intersection) {
+	*this << "Between rectangles ";
+	const std::span<const Rectangle::ID> members = intersection.getMembers();
+	for (size_t i = 0; i < members.size(); i++) {
+		*this << members[i];
+		if (i + 2 < members.size()) {
+			*this << ", ";
+		} else if (i + 1 < members.size()) {
+			*this << " and ";
+		}
+	}
+
+	const WideBox shape = inputBox(intersection.getShapeRef());
+	return *this << " at (" << shape.left << ", " << shape.top << ") w=" << shape.right - shape.left
+	             << ", h=" << shape.bottom - shape.top;
+}
+
+void OutputWriter::setCoordinateMap(const CoordinateMap *coordinates) {
+	this->coordinates = coordinates;
+}
+
+void OutputWriter::flush() {
+	if (used == 0) {
+		return;
+	}
+	stream.write(buffer.data(), static_cast<std::streamsize>(used));
+	stream.flush();
+	used = 0;
+}
+
+void OutputWriter::reserve(size_t size) {
+	if (buffer.size() - used < size) {
+		flush();
+	}
+}
+
+WideBox OutputWriter::inputBox(const Rectangle &rectangle) const {
+	if (coordinates != nullptr) {
+		return coordinates->expand(rectangle.getBox());
+	}
+	return {rectangle.getLeft(), rectangle.getTop(), rectangle.getRight(), rectangle.getBottom()};
+}
+
+} // namespace nitro
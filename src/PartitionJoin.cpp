@@ -0,0 +1,135 @@
+#include "PartitionJoin.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nitro {
+
+PartitionJoin::PartitionJoin(const RectangleStore &first, const RectangleStore &second, size_t tileCount) {
+	if (first.empty() || second.empty()) {
+		return;
+	}
+
+	int64_t minX = std::numeric_limits<int64_t>::max();
+	int64_t minY = std::numeric_limits<int64_t>::max();
+	int64_t maxX = std::numeric_limits<int64_t>::min();
+	int64_t maxY = std::numeric_limits<int64_t>::min();
+	for (const RectangleStore *store : {&first, &second}) {
+		for (size_t i = 0; i < store->size(); i++) {
+			minX = std::min<int64_t>(minX, store->getLeft(i));
+			minY = std::min<int64_t>(minY, store->getTop(i));
+			maxX = std::max<int64_t>(maxX, store->getRight(i));
+			maxY = std::max<int64_t>(maxY, store->getBottom(i));
+		}
+	}
+
+	if (tileCount == AUTOMATIC_TILE_COUNT) {
+		tileCount = (first.size() + second.size()) / RECTANGLES_PER_TILE;
+	}
+	tileCount = std::max<size_t>(tileCount, 1);
+	this->columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+	this->rows = (tileCount + this->columns - 1) / this->columns;
+	this->originX = minX;
+	this->originY = minY;
+	this->tileWidth = (maxX - minX) / static_cast<int64_t>(this->columns) + 1;
+	this->tileHeight = (maxY - minY) / static_cast<int64_t>(this->rows) + 1;
+
+	partition(first, firstStarts, firstEntries);
+	partition(second, secondStarts, secondEntries);
+}
+
+size_t PartitionJoin::getTileCount() const {
+	return columns * rows;
+}
+
+size_t PartitionJoin::getColumnCount() const {
+	return columns;
+}
+
+size_t PartitionJoin::getRowCount() const {
+	return rows;
+}
+
+size_t PartitionJoin::columnOf(int64_t x) const {
+	return static_cast<size_t>((x - originX) / tileWidth);
+}
+
+size_t PartitionJoin::rowOf(int64_t y) const {
+	return static_cast<size_t>((y - originY) / tileHeight);
+}
+
+void PartitionJoin::partition(const RectangleStore &store, std::vector<size_t> &starts,
+                              std::vector<size_t> &entries) const {
+	// Rectangles are listed in every tile they touch, edges included, so the tile holding the corner of an overlap
+	// always lists both rectangles
+	starts.assign(columns * rows + 1, 0);
+	for (size_t i = 0; i < store.size(); i++) {
+		for (size_t row = rowOf(store.getTop(i)); row <= rowOf(store.getBottom(i)); row++) {
+			for (size_t column = columnOf(store.getLeft(i)); column <= columnOf(store.getRight(i)); column++) {
+				starts[row * columns + column + 1]++;
+			}
+		}
+	}
+	for (size_t tile = 1; tile < starts.size(); tile++) {
+		starts[tile] += starts[tile - 1];
+	}
+
+	std::vector<size_t> fill{starts.begin(), starts.end() - 1};
+	entries.resize(starts.back());
+	for (size_t i = 0; i < store.size(); i++) {
+		for (size_t row = rowOf(store.getTop(i)); row <= rowOf(store.getBottom(i)); row++) {
+			for (size_t column = columnOf(store.getLeft(i)); column <= columnOf(store.getRight(i)); column++) {
+				entries[fill[row * columns + column]++] = i;
+			}
+		}
+	}
+
+	// Tiles are swept from left to right
+	for (size_t tile = 0; tile + 1 < starts.size(); tile++) {
+		std::sort(entries.begin() + starts[tile], entries.begin() + starts[tile + 1],
+		          [&store](size_t a, size_t b) { return store.getLeft(a) < store.getLeft(b); });
+	}
+}
+
+void PartitionJoin::joinTile(const RectangleStore &first, const RectangleStore &second, size_t tile,
+                             const PairCallback &callback) const {
+	if (tile >= getTileCount()) {
+		return;
+	}
+
+	const size_t *firstEntry = firstEntries.data() + firstStarts[tile];
+	const size_t *firstEnd = firstEntries.data() + firstStarts[tile + 1];
+	const size_t *secondEntry = secondEntries.data() + secondStarts[tile];
+	const size_t *secondEnd = secondEntries.data() + secondStarts[tile + 1];
+
+	const auto report = [&](size_t a, size_t b) {
+		const int left = std::max(first.getLeft(a), second.getLeft(b));
+		const int top = std::max(first.getTop(a), second.getTop(b));
+		const int right = std::min(first.getRight(a), second.getRight(b));
+		const int bottom = std::min(first.getBottom(a), second.getBottom(b));
+		if (top >= bottom || left >= right || rowOf(top) * columns + columnOf(left) != tile) {
+			return;
+		}
+		callback(a, b, left, top, right, bottom);
+	};
+
+	// Merge both lists by left edge. The rectangle with the lower left edge is matched against the rectangles
+	// of the other side that start before it ends, and is then done with.
+	while (firstEntry != firstEnd && secondEntry != secondEnd) {
+		if (first.getLeft(*firstEntry) <= second.getLeft(*secondEntry)) {
+			const int right = first.getRight(*firstEntry);
+			for (const size_t *other = secondEntry; other != secondEnd && second.getLeft(*other) < right; other++) {
+				report(*firstEntry, *other);
+			}
+			firstEntry++;
+		} else {
+			const int right = second.getRight(*secondEntry);
+			for (const size_t *other = firstEntry; other != firstEnd && first.getLeft(*other) < right; other++) {
+				report(*other, *secondEntry);
+			}
+			secondEntry++;
+		}
+	}
+}
+
+} // namespace nitro
@@ -0,0 +1,170 @@
+#include "RTree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nitro {
+
+namespace {
+
+// A bounding box waiting to be packed into a node of the level above
+struct PackItem {
+		int left;
+		int top;
+		int right;
+		int bottom;
+		size_t entry;
+
+		int64_t centerX() const {
+			return static_cast<int64_t>(left) + right;
+		}
+
+		int64_t centerY() const {
+			return static_cast<int64_t>(top) + bottom;
+		}
+};
+
+} // namespace
+
+RTree::RTree(const RectangleStore &store) {
+	if (store.empty()) {
+		return;
+	}
+
+	std::vector<PackItem> items;
+	items.reserve(store.size());
+	for (size_t i = 0; i < store.size(); i++) {
+		items.push_back({store.getLeft(i), store.getTop(i), store.getRight(i), store.getBottom(i), i});
+	}
+
+	// Sort-Tile-Recursive: sort by X into vertical slabs of whole nodes, sort every slab by Y and pack it in runs.
+	// The nodes of a level become the items of the level above, until a single root is left.
+	bool leaf = true;
+	while (true) {
+		const size_t nodeCount = (items.size() + NODE_CAPACITY - 1) / NODE_CAPACITY;
+		const size_t slabCount = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodeCount))));
+		const size_t slabSize = ((nodeCount + slabCount - 1) / slabCount) * NODE_CAPACITY;
+
+		std::sort(items.begin(), items.end(),
+		          [](const PackItem &a, const PackItem &b) { return a.centerX() < b.centerX(); });
+		for (size_t slab = 0; slab < items.size(); slab += slabSize) {
+			auto slabEnd = items.begin() + std::min(slab + slabSize, items.size());
+			std::sort(items.begin() + slab, slabEnd,
+			          [](const PackItem &a, const PackItem &b) { return a.centerY() < b.centerY(); });
+		}
+
+		std::vector<PackItem> parents;
+		parents.reserve(nodeCount);
+		for (size_t first = 0; first < items.size(); first += NODE_CAPACITY) {
+			Node node{};
+			node.leaf = leaf;
+			node.count = std::min(NODE_CAPACITY, items.size() - first);
+
+			PackItem bounds{std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+			                std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), nodes.size()};
+			for (size_t i = 0; i < node.count; i++) {
+				const PackItem &item = items[first + i];
+				node.boxes.lefts[i] = item.left;
+				node.boxes.tops[i] = item.top;
+				node.boxes.rights[i] = item.right;
+				node.boxes.bottoms[i] = item.bottom;
+				node.entries[i] = item.entry;
+
+				bounds.left = std::min(bounds.left, item.left);
+				bounds.top = std::min(bounds.top, item.top);
+				bounds.right = std::max(bounds.right, item.right);
+				bounds.bottom = std::max(bounds.bottom, item.bottom);
+			}
+
+			nodes.push_back(node);
+			parents.push_back(bounds);
+		}
+
+		height++;
+		leaf = false;
+		if (parents.size() == 1) {
+			break;
+		}
+		items = std::move(parents);
+	}
+}
+
+size_t RTree::getNodeCount() const {
+	return nodes.size();
+}
+
+size_t RTree::getHeight() const {
+	return height;
+}
+
+void RTree::forEachPair(const RectangleStore &store, const PairCallback &callback) const {
+	// Every rectangle is matched against the tree, and pairs are only reported from their lower index
+	if (nodes.empty()) {
+		return;
+	}
+
+	IntersectionKernel::Block clipped;
+	std::vector<size_t> pending;
+	for (size_t first = 0; first < store.size(); first++) {
+		const int left = store.getLeft(first);
+		const int top = store.getTop(first);
+		const int right = store.getRight(first);
+		const int bottom = store.getBottom(first);
+
+		pending.push_back(nodes.size() - 1);
+		while (!pending.empty()) {
+			const Node &node = nodes[pending.back()];
+			pending.pop_back();
+
+			const uint32_t hits =
+			    IntersectionKernel::intersect(left, top, right, bottom, node.boxes.lefts, node.boxes.tops,
+			                                  node.boxes.rights, node.boxes.bottoms, node.count, clipped);
+			for (size_t i = 0; i < node.count; i++) {
+				if ((hits & (1u << i)) == 0) {
+					continue;
+				}
+				if (!node.leaf) {
+					pending.push_back(node.entries[i]);
+				} else if (node.entries[i] > first) {
+					callback(first, node.entries[i], clipped.lefts[i], clipped.tops[i], clipped.rights[i],
+					         clipped.bottoms[i]);
+				}
+			}
+		}
+	}
+}
+
+std::vector<size_t> RTree::queryPoint(int x, int y) const {
+	return queryWindow(x, y, x, y);
+}
+
+std::vector<size_t> RTree::queryWindow(int left, int top, int right, int bottom) const {
+	// Edges count as covered, so line rectangles and windows can be found as well
+	std::vector<size_t> result;
+	if (nodes.empty()) {
+		return result;
+	}
+
+	std::vector<size_t> pending{nodes.size() - 1};
+	while (!pending.empty()) {
+		const Node &node = nodes[pending.back()];
+		pending.pop_back();
+
+		for (size_t i = 0; i < node.count; i++) {
+			if (node.boxes.lefts[i] > right || left > node.boxes.rights[i] || node.boxes.tops[i] > bottom ||
+			    top > node.boxes.bottoms[i]) {
+				continue;
+			}
+			if (node.leaf) {
+				result.push_back(node.entries[i]);
+			} else {
+				pending.push_back(node.entries[i]);
+			}
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+} // namespace nitro
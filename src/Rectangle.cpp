@@ -24,6 +24,7 @@ Rectangle::Rectangle(Rectangle::ID id, Vertex topLeft, uint32_t width, uint32_t
 	}
 
 	// vertex calculation and validation
+	Vertices vertices;
 	vertices.topLeft = topLeft;
 	vertices.bottomLeft = {topLeft.x, topLeft.y + static_cast<int>(height)};
 	vertices.topRight = {topLeft.x + static_cast<int>(width), topLeft.y};
@@ -33,8 +34,7 @@ Rectangle::Rectangle(Rectangle::ID id, Vertex topLeft, uint32_t width, uint32_t
 		throw std::runtime_error("Rectangle vertice validation failed");
 	}
 
-	this->width = width;
-	this->height = height;
+	this->box = {vertices.topLeft.x, vertices.topLeft.y, vertices.bottomRight.x, vertices.bottomRight.y};
 
 	if (id == 0) {
 		throw std::invalid_argument("Rectangle IDs must be > 0");
@@ -53,15 +53,16 @@ void Rectangle::setId(Rectangle::ID id) {
 }
 
 Rectangle::Vertices Rectangle::getVertices() const {
-	return vertices;
+	return {{box.left, box.bottom}, {box.right, box.bottom}, {box.left, box.top}, {box.right, box.top}};
 }
 
+// Extents go up to UINT32_MAX, beyond what an int subtraction can hold
 uint32_t Rectangle::getWidth() const {
-	return width;
+	return static_cast<uint32_t>(static_cast<int64_t>(box.right) - box.left);
 }
 
 uint32_t Rectangle::getHeight() const {
-	return height;
+	return static_cast<uint32_t>(static_cast<int64_t>(box.bottom) - box.top);
 }
 
 bool Rectangle::validateVertices(const Vertex &bottomLeft, const Vertex &bottomRight, const Vertex &topLeft,
@@ -75,21 +76,12 @@ bool Rectangle::validateVertices(const Vertex &bottomLeft, const Vertex &bottomR
 }
 
 std::optional<Rectangle> Rectangle::intersection(const Rectangle &rectangle1, const Rectangle &rectangle2) {
-	Rectangle::Vertices r1Vertices = rectangle1.getVertices();
-	Rectangle::Vertices r2Vertices = rectangle2.getVertices();
-
-	const int interLeftEdge = std::max(r1Vertices.topLeft.x, r2Vertices.topLeft.x);
-	const int interRightEdge = std::min(r1Vertices.topRight.x, r2Vertices.topRight.x);
-	const int interTopEdge = std::max(r1Vertices.topLeft.y, r2Vertices.topLeft.y);
-	const int interBottomEdge = std::min(r1Vertices.bottomLeft.y, r2Vertices.bottomLeft.y);
-
-	if ((interLeftEdge < interRightEdge) && (interBottomEdge > interTopEdge)) {
-		Vertex topLeftVertexX = {interLeftEdge, interTopEdge};
-		uint32_t width = static_cast<uint32_t>(interRightEdge - interLeftEdge);
-		uint32_t height = static_cast<uint32_t>(interBottomEdge - interTopEdge);
+	const Box overlap = Box::clip(rectangle1.box, rectangle2.box);
+	if (overlap.hasArea()) {
 		// RectangleIntersections will be  identified by the IDs of the intersecting rectangles
-		// the Rectangle shape that composes the RectangleIntersection doesn't need a unique ID
-		return Rectangle{Rectangle::ID_UNDEFINED, topLeftVertexX, width, height};
+		// the Rectangle shape that composes the RectangleIntersection doesn't need a unique ID.
+		// The overlap of two valid rectangles with a positive area is valid too, so it skips the checks.
+		return Rectangle::fromBox(Rectangle::ID_UNDEFINED, overlap);
 	}
 
 	return std::nullopt;
@@ -100,8 +92,8 @@ std::optional<Rectangle> Rectangle::intersect(const Rectangle &other) {
 }
 
 std::string Rectangle::toString() const {
-	return std::to_string(id) + ": " + "Rectangle at ("+ std::to_string(vertices.topLeft.x) + "," +
-		   std::to_string(vertices.topLeft.y) + "), w=" + std::to_string(width) + ", h=" + std::to_string(height);
+	return std::to_string(id) + ": " + "Rectangle at ("+ std::to_string(box.left) + "," +
+		   std::to_string(box.top) + "), w=" + std::to_string(getWidth()) + ", h=" + std::to_string(getHeight());
 }
 
 } // namespace nitro
\ No newline at end of file
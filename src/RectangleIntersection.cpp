@@ -1,55 +1,154 @@
 #include "RectangleIntersection.hpp"
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace nitro {
 
 Canvas::RectangleIntersection::RectangleIntersection(const Rectangle &shape, const std::set<Rectangle::ID> &members)
-    : shape{shape}, intersectingRectangles{members} {
+    : shape{shape} {
 
-	for (const auto &id : this->intersectingRectangles) {
+	Rectangle::ID *ids = this->allocateMembers(members.size());
+	for (const auto &id : members) {
 		if (id <= 0) {
 			throw std::invalid_argument("RectangleIntersection: All rectangle IDs must be > 0");
 		}
+		*ids++ = id;
 	}
 }
 
+Canvas::RectangleIntersection::RectangleIntersection(const Rectangle &shape, Rectangle::ID first,
+                                                     Rectangle::ID second)
+    : shape{shape} {
+
+	if (first <= 0 || second <= 0) {
+		throw std::invalid_argument("RectangleIntersection: All rectangle IDs must be > 0");
+	}
+
+	this->memberCount = 2;
+	this->inlineMembers[0] = std::min(first, second);
+	this->inlineMembers[1] = std::max(first, second);
+}
+
+Canvas::RectangleIntersection::RectangleIntersection(const Rectangle &shape, std::span<const Rectangle::ID> members)
+    : shape{shape} {
+
+	Rectangle::ID *ids = this->allocateMembers(members.size());
+	for (const auto &id : members) {
+		if (id <= 0) {
+			throw std::invalid_argument("RectangleIntersection: All rectangle IDs must be > 0");
+		}
+		*ids++ = id;
+	}
+}
+
+Canvas::RectangleIntersection::RectangleIntersection(const Rectangle &shape, const RectangleIntersection &base,
+                                                     Rectangle::ID member, std::pmr::memory_resource *resource)
+    : shape{shape}, spilledMembers{resource} {
+
+	if (member <= 0) {
+		throw std::invalid_argument("RectangleIntersection: All rectangle IDs must be > 0");
+	}
+
+	// The new member is merged into its sorted position
+	const std::span<const Rectangle::ID> baseMembers = base.getMembers();
+	Rectangle::ID *ids = this->allocateMembers(baseMembers.size() + 1);
+	auto position = std::lower_bound(baseMembers.begin(), baseMembers.end(), member);
+	ids = std::copy(baseMembers.begin(), position, ids);
+	*ids++ = member;
+	std::copy(position, baseMembers.end(), ids);
+}
+
+Canvas::RectangleIntersection::RectangleIntersection(RectangleIntersection &&other) noexcept
+    : shape{other.shape}, memberCount{other.memberCount}, spilledMembers{std::move(other.spilledMembers)} {
+
+	std::copy(std::begin(other.inlineMembers), std::end(other.inlineMembers), this->inlineMembers);
+	// The spilled members were taken, so the source can't keep claiming them
+	other.memberCount = 0;
+}
+
+Canvas::RectangleIntersection &Canvas::RectangleIntersection::operator=(const RectangleIntersection &other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	// Built first, so a failed allocation leaves this RectangleIntersection as it was
+	std::pmr::vector<Rectangle::ID> members{other.spilledMembers, std::pmr::get_default_resource()};
+	this->shape = other.shape;
+	this->memberCount = other.memberCount;
+	std::copy(std::begin(other.inlineMembers), std::end(other.inlineMembers), this->inlineMembers);
+	this->adoptSpilledMembers(std::move(members));
+	return *this;
+}
+
+Canvas::RectangleIntersection &Canvas::RectangleIntersection::operator=(RectangleIntersection &&other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+
+	this->shape = other.shape;
+	this->memberCount = other.memberCount;
+	std::copy(std::begin(other.inlineMembers), std::end(other.inlineMembers), this->inlineMembers);
+	this->adoptSpilledMembers(std::move(other.spilledMembers));
+	other.memberCount = 0;
+	return *this;
+}
+
+void Canvas::RectangleIntersection::adoptSpilledMembers(std::pmr::vector<Rectangle::ID> &&members) noexcept {
+	std::destroy_at(&this->spilledMembers);
+	std::construct_at(&this->spilledMembers, std::move(members));
+}
+
+Rectangle::ID *Canvas::RectangleIntersection::allocateMembers(size_t count) {
+	this->memberCount = static_cast<uint32_t>(count);
+	if (count <= INLINE_MEMBERS) {
+		return this->inlineMembers;
+	}
+	this->spilledMembers.resize(count);
+	return this->spilledMembers.data();
+}
+
 Rectangle Canvas::RectangleIntersection::getShape() const {
 	return shape;
 }
 
 std::set<Rectangle::ID> Canvas::RectangleIntersection::getIntersectingRectangles() const {
-	return intersectingRectangles;
+	const std::span<const Rectangle::ID> members = this->getMembers();
+	return {members.begin(), members.end()};
 }
 
 Rectangle::ID Canvas::RectangleIntersection::getRectIdAtIndex(size_t index) const {
-	if (index >= intersectingRectangles.size()) {
+	if (index >= memberCount) {
 		throw std::out_of_range("Index out of range");
 	}
 
-	auto it = intersectingRectangles.begin();
-	std::advance(it, index);
-	return *it;
+	return this->getMembers()[index];
+}
+
+bool Canvas::RectangleIntersection::contains(Rectangle::ID id) const {
+	const std::span<const Rectangle::ID> members = this->getMembers();
+	return std::binary_search(members.begin(), members.end(), id);
 }
 
 std::string Canvas::RectangleIntersection::toString() const {
 	std::string result = "Between rectangles ";
 	size_t i = 0;
-	for (Rectangle::ID id : intersectingRectangles) {
+	for (Rectangle::ID id : this->getMembers()) {
 		result += std::to_string(id);
 
-		if (i < intersectingRectangles.size() - 2) {
+		if (i + 2 < memberCount) {
 			result += ", ";
-		} else if (i < intersectingRectangles.size() - 1) {
+		} else if (i + 1 < memberCount) {
 			result += " and ";
 		}
 		i++;
 	}
 	result += " at ";
-	Rectangle shape = this->getShape();
-	result += "(" + std::to_string(shape.getVertices().topLeft.x) + ", " +
-	          std::to_string(shape.getVertices().topLeft.y) + ") w=" + std::to_string(shape.getWidth()) +
-	          ", h=" + std::to_string(shape.getHeight());
+	result += "(" + std::to_string(shape.getLeft()) + ", " + std::to_string(shape.getTop()) +
+	          ") w=" + std::to_string(shape.getWidth()) + ", h=" + std::to_string(shape.getHeight());
 	return result;
 }
 
@@ -0,0 +1,95 @@
+#include "RectangleStore.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace nitro {
+
+Rectangle RectangleStore::at(size_t index) const {
+	if (index >= size()) {
+		throw std::out_of_range("Index out of range");
+	}
+
+	// Rectangles were validated when they were pushed
+	return Rectangle::fromBox(ids[index], {lefts[index], tops[index], rights[index], bottoms[index]});
+}
+
+std::optional<size_t> RectangleStore::indexOf(Rectangle::ID id) const {
+	auto it = indices.find(id);
+	return it == indices.end() ? std::nullopt : std::make_optional(it->second);
+}
+
+std::span<const Rectangle::ID> RectangleStore::getIds() const {
+	return ids;
+}
+
+std::span<const int> RectangleStore::getLefts() const {
+	return lefts;
+}
+
+std::span<const int> RectangleStore::getTops() const {
+	return tops;
+}
+
+std::span<const int> RectangleStore::getRights() const {
+	return rights;
+}
+
+std::span<const int> RectangleStore::getBottoms() const {
+	return bottoms;
+}
+
+void RectangleStore::reserve(size_t capacity) {
+	ids.reserve(capacity);
+	lefts.reserve(capacity);
+	tops.reserve(capacity);
+	rights.reserve(capacity);
+	bottoms.reserve(capacity);
+	indices.reserve(capacity);
+}
+
+void RectangleStore::push_back(const Rectangle &rectangle) {
+	Rectangle::ID id = rectangle.getId();
+	if (!indices.emplace(id, ids.size()).second) {
+		throw std::invalid_argument("Duplicate ID: " + std::to_string(id));
+	}
+
+	ids.push_back(id);
+	lefts.push_back(rectangle.getLeft());
+	tops.push_back(rectangle.getTop());
+	rights.push_back(rectangle.getRight());
+	bottoms.push_back(rectangle.getBottom());
+}
+
+void RectangleStore::erase(size_t index) {
+	if (index >= size()) {
+		throw std::out_of_range("Index out of range");
+	}
+
+	const size_t last = size() - 1;
+	indices.erase(ids[index]);
+	if (index != last) {
+		ids[index] = ids[last];
+		lefts[index] = lefts[last];
+		tops[index] = tops[last];
+		rights[index] = rights[last];
+		bottoms[index] = bottoms[last];
+		indices[ids[index]] = index;
+	}
+
+	ids.pop_back();
+	lefts.pop_back();
+	tops.pop_back();
+	rights.pop_back();
+	bottoms.pop_back();
+}
+
+void RectangleStore::clear() {
+	ids.clear();
+	lefts.clear();
+	tops.clear();
+	rights.clear();
+	bottoms.clear();
+	indices.clear();
+}
+
+} // namespace nitro
@@ -0,0 +1,130 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace nitro {
+
+ThreadPool::ThreadPool(size_t threadCount) : threadCount(threadCount) {
+	if (this->threadCount == 0) {
+		this->threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	if (this->threadCount == 1) {
+		return;
+	}
+
+	for (size_t worker = 0; worker < this->threadCount; worker++) {
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (size_t worker = 0; worker < this->threadCount; worker++) {
+		threads.emplace_back(&ThreadPool::workerLoop, this, worker);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+size_t ThreadPool::getThreadCount() const {
+	return threadCount;
+}
+
+void ThreadPool::run(size_t taskCount, const Task &task) {
+	std::lock_guard<std::mutex> runLock(runMutex);
+
+	if (threads.empty()) {
+		for (size_t i = 0; i < taskCount; i++) {
+			task(i, 0);
+		}
+		return;
+	}
+
+	// Every worker starts with a contiguous range of tasks
+	for (size_t i = 0; i < taskCount; i++) {
+		WorkerQueue &queue = *queues[i * threadCount / taskCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(i);
+	}
+
+	std::unique_lock<std::mutex> lock(stateMutex);
+	currentTask = &task;
+	error = nullptr;
+	busyWorkers = threadCount;
+	generation++;
+	workAvailable.notify_all();
+
+	workFinished.wait(lock, [this] { return busyWorkers == 0; });
+	currentTask = nullptr;
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+	size_t seenGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			workAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping) {
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		drainQueues(worker);
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+		if (--busyWorkers == 0) {
+			workFinished.notify_all();
+		}
+	}
+}
+
+void ThreadPool::drainQueues(size_t worker) {
+	size_t task = 0;
+	while (nextTask(worker, task)) {
+		try {
+			(*currentTask)(task, worker);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(stateMutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	}
+}
+
+bool ThreadPool::nextTask(size_t worker, size_t &task) {
+	// Own tasks are taken from the front, stolen tasks from the back of another worker's queue
+	{
+		WorkerQueue &queue = *queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	for (size_t offset = 1; offset < threadCount; offset++) {
+		WorkerQueue &queue = *queues[(worker + offset) % threadCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+} // namespace nitro
@@ -0,0 +1,231 @@
+#include "TiledIntersector.hpp"
+#include "RectangleIntersection.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace nitro {
+
+TiledIntersector::TiledIntersector(const std::filesystem::path &directory, size_t rectanglesPerTile)
+    : rectanglesPerTile(std::max<size_t>(rectanglesPerTile, 1)), minX(std::numeric_limits<int64_t>::max()),
+      minY(std::numeric_limits<int64_t>::max()), maxX(std::numeric_limits<int64_t>::min()),
+      maxY(std::numeric_limits<int64_t>::min()) {
+	// Several runs may share the same temporary directory
+	std::random_device random;
+	do {
+		this->directory = directory / ("rectangle_tiles_" + std::to_string(random()));
+	} while (!std::filesystem::create_directories(this->directory));
+}
+
+TiledIntersector::~TiledIntersector() {
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
+
+size_t TiledIntersector::getRectangleCount() const {
+	return rectangleCount;
+}
+
+size_t TiledIntersector::getTileCount() const {
+	return columns * rows;
+}
+
+size_t TiledIntersector::getRecordSize() const {
+	if (buffers.empty()) {
+		return 0;
+	}
+	return narrowRecords ? sizeof(Record<uint16_t>) : sizeof(Record<int32_t>);
+}
+
+size_t TiledIntersector::getExaminedCount() const {
+	return examinedCount;
+}
+
+const std::filesystem::path &TiledIntersector::getDirectory() const {
+	return directory;
+}
+
+void TiledIntersector::setThreadCount(size_t threadCount) {
+	// Thread count 0 uses every hardware thread
+	this->threadPool = threadCount == 1 ? nullptr : std::make_shared<ThreadPool>(threadCount);
+}
+
+void TiledIntersector::setLimits(const Canvas::Limits &limits) {
+	this->limits = limits;
+}
+
+void TiledIntersector::measure(const Rectangle &rectangle) {
+	if (!buffers.empty()) {
+		throw std::logic_error("Rectangles can't be measured once spilling started");
+	}
+
+	minX = std::min<int64_t>(minX, rectangle.getLeft());
+	minY = std::min<int64_t>(minY, rectangle.getTop());
+	maxX = std::max<int64_t>(maxX, rectangle.getRight());
+	maxY = std::max<int64_t>(maxY, rectangle.getBottom());
+	rectangleCount++;
+}
+
+void TiledIntersector::layout() {
+	if (rectangleCount == 0) {
+		throw std::logic_error("No rectangles were measured");
+	}
+
+	const size_t tileCount = (rectangleCount + rectanglesPerTile - 1) / rectanglesPerTile;
+	columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+	rows = (tileCount + columns - 1) / columns;
+	tileWidth = (maxX - minX) / static_cast<int64_t>(columns) + 1;
+	tileHeight = (maxY - minY) / static_cast<int64_t>(rows) + 1;
+	buffers.resize(columns * rows);
+
+	// Narrow records are relative to the top left corner of the extent, wide records keep the coordinates as they are
+	const int64_t narrowSpan = std::numeric_limits<uint16_t>::max();
+	narrowRecords = maxX - minX <= narrowSpan && maxY - minY <= narrowSpan;
+	recordOriginX = narrowRecords ? minX : 0;
+	recordOriginY = narrowRecords ? minY : 0;
+}
+
+size_t TiledIntersector::columnOf(int64_t x) const {
+	return static_cast<size_t>((x - minX) / tileWidth);
+}
+
+size_t TiledIntersector::rowOf(int64_t y) const {
+	return static_cast<size_t>((y - minY) / tileHeight);
+}
+
+std::filesystem::path TiledIntersector::tilePath(size_t tile) const {
+	return directory / ("tile_" + std::to_string(tile));
+}
+
+void TiledIntersector::spill(const Rectangle &rectangle) {
+	if (buffers.empty()) {
+		layout();
+	}
+
+	const Box &box = rectangle.getBox();
+	if (box.left < minX || box.top < minY || box.right > maxX || box.bottom > maxY) {
+		throw std::logic_error("Rectangle was not measured: " + std::to_string(rectangle.getId()));
+	}
+
+	if (narrowRecords) {
+		spillAs<uint16_t>(rectangle);
+	} else {
+		spillAs<int32_t>(rectangle);
+	}
+}
+
+template <typename Coordinate> void TiledIntersector::spillAs(const Rectangle &rectangle) {
+	const Box &box = rectangle.getBox();
+	const Record<Coordinate> record{rectangle.getId(),
+	                                {static_cast<Coordinate>(box.left - recordOriginX),
+	                                 static_cast<Coordinate>(box.top - recordOriginY),
+	                                 static_cast<Coordinate>(box.right - recordOriginX),
+	                                 static_cast<Coordinate>(box.bottom - recordOriginY)}};
+	const char *bytes = reinterpret_cast<const char *>(&record);
+
+	// Rectangles go to every tile they touch, edges included, so the tile holding the corner of an intersection
+	// has all of its rectangles
+	for (size_t row = rowOf(box.top); row <= rowOf(box.bottom); row++) {
+		for (size_t column = columnOf(box.left); column <= columnOf(box.right); column++) {
+			const size_t tile = row * columns + column;
+			buffers[tile].insert(buffers[tile].end(), bytes, bytes + sizeof(record));
+			if (buffers[tile].size() == WRITE_BUFFER_RECORDS * sizeof(record)) {
+				flush(tile);
+			}
+		}
+	}
+}
+
+void TiledIntersector::flush(size_t tile) {
+	if (buffers[tile].empty()) {
+		return;
+	}
+
+	std::ofstream file(tilePath(tile), std::ios::binary | std::ios::app);
+	file.write(buffers[tile].data(), static_cast<std::streamsize>(buffers[tile].size()));
+	if (!file) {
+		throw std::runtime_error("Could not write tile file: " + tilePath(tile).string());
+	}
+	buffers[tile].clear();
+}
+
+std::vector<Rectangle> TiledIntersector::loadTile(size_t tile) const {
+	std::vector<Rectangle> rectangles;
+	std::ifstream file(tilePath(tile), std::ios::binary);
+	if (!file.is_open()) {
+		return rectangles;
+	}
+
+	if (narrowRecords) {
+		loadAs<uint16_t>(file, rectangles);
+	} else {
+		loadAs<int32_t>(file, rectangles);
+	}
+	return rectangles;
+}
+
+template <typename Coordinate>
+void TiledIntersector::loadAs(std::ifstream &file, std::vector<Rectangle> &rectangles) const {
+	Record<Coordinate> record;
+	while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+		// Records were written from validated rectangles
+		rectangles.push_back(Rectangle::fromBox(record.id, {static_cast<int>(record.box.left + recordOriginX),
+		                                                    static_cast<int>(record.box.top + recordOriginY),
+		                                                    static_cast<int>(record.box.right + recordOriginX),
+		                                                    static_cast<int>(record.box.bottom + recordOriginY)}));
+	}
+}
+
+Canvas::LimitReached TiledIntersector::streamIntersections(const Canvas::IntersectionSink &sink) {
+	for (size_t tile = 0; tile < buffers.size(); tile++) {
+		flush(tile);
+	}
+
+	Canvas::LimitReached limitReached = Canvas::LimitReached::None;
+	size_t reported = 0;
+	examinedCount = 0;
+	for (size_t tile = 0; tile < getTileCount(); tile++) {
+		std::vector<Rectangle> rectangles = loadTile(tile);
+		if (rectangles.size() < 2) {
+			continue;
+		}
+
+		// Only this tile is held in memory while it is intersected
+		Canvas canvas{rectangles};
+		rectangles = {};
+		canvas.setThreadPool(threadPool);
+		canvas.setLimits({limits.maxOrder, 0, limits.memoryBudget});
+
+		// The tile's own limit can't be maxResults, which only counts the intersections the tile reports: the sink
+		// stops the enumeration instead, as soon as one more than the limit would be reported
+		const Canvas::LimitReached tileLimit =
+		    canvas.streamIntersectionsWhile([&](const Canvas::RectangleIntersection &intersection) {
+			    examinedCount++;
+			    const Rectangle &shape = intersection.getShapeRef();
+			    if (rowOf(shape.getTop()) * columns + columnOf(shape.getLeft()) != tile) {
+				    return true;
+			    }
+			    if (limits.maxResults != 0 && reported == limits.maxResults) {
+				    limitReached = Canvas::LimitReached::MaxResults;
+				    return false;
+			    }
+			    sink(intersection);
+			    reported++;
+			    return true;
+		    });
+
+		if (limitReached == Canvas::LimitReached::MaxResults) {
+			break;
+		}
+		if (limitReached == Canvas::LimitReached::None) {
+			limitReached = tileLimit;
+		}
+	}
+	return limitReached;
+}
+
+} // namespace nitro
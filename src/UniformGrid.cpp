@@ -0,0 +1,136 @@
+#include "UniformGrid.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace nitro {
+
+namespace {
+
+// Upper bound for the number of cells, relative to the number of rectangles
+const size_t MAX_CELLS_PER_RECTANGLE = 4;
+
+} // namespace
+
+UniformGrid::UniformGrid(const RectangleStore &store, int64_t cellSize) {
+	if (store.empty()) {
+		return;
+	}
+
+	int64_t minX = std::numeric_limits<int64_t>::max();
+	int64_t minY = std::numeric_limits<int64_t>::max();
+	int64_t maxX = std::numeric_limits<int64_t>::min();
+	int64_t maxY = std::numeric_limits<int64_t>::min();
+	int64_t extentSum = 0;
+	for (size_t i = 0; i < store.size(); i++) {
+		minX = std::min<int64_t>(minX, store.getLeft(i));
+		minY = std::min<int64_t>(minY, store.getTop(i));
+		maxX = std::max<int64_t>(maxX, store.getRight(i));
+		maxY = std::max<int64_t>(maxY, store.getBottom(i));
+		const int64_t width = static_cast<int64_t>(store.getRight(i)) - store.getLeft(i);
+		const int64_t height = static_cast<int64_t>(store.getBottom(i)) - store.getTop(i);
+		extentSum += (width + height) / 2;
+	}
+
+	if (cellSize <= AUTOMATIC_CELL_SIZE) {
+		cellSize = extentSum / static_cast<int64_t>(store.size());
+	}
+	this->cellSize = std::max<int64_t>(cellSize, 1);
+	this->originX = minX;
+	this->originY = minY;
+
+	// Few large rectangles spread over a wide canvas would otherwise produce a mostly empty grid
+	const size_t maxCells = MAX_CELLS_PER_RECTANGLE * store.size() + 16;
+	while (true) {
+		this->columns = static_cast<size_t>((maxX - minX) / this->cellSize) + 1;
+		this->rows = static_cast<size_t>((maxY - minY) / this->cellSize) + 1;
+		if (this->columns <= maxCells / this->rows) {
+			break;
+		}
+		this->cellSize *= 2;
+	}
+
+	// Rectangles are listed in every cell they touch, edges included, so the cell holding the corner of an overlap
+	// always has both rectangles
+	cellStarts.assign(this->columns * this->rows + 1, 0);
+	for (size_t i = 0; i < store.size(); i++) {
+		for (size_t row = rowOf(store.getTop(i)); row <= rowOf(store.getBottom(i)); row++) {
+			for (size_t column = columnOf(store.getLeft(i)); column <= columnOf(store.getRight(i)); column++) {
+				cellStarts[row * this->columns + column + 1]++;
+			}
+		}
+	}
+	for (size_t cell = 1; cell < cellStarts.size(); cell++) {
+		cellStarts[cell] += cellStarts[cell - 1];
+	}
+
+	std::vector<size_t> fill{cellStarts.begin(), cellStarts.end() - 1};
+	cellEntries.resize(cellStarts.back());
+	for (size_t i = 0; i < store.size(); i++) {
+		for (size_t row = rowOf(store.getTop(i)); row <= rowOf(store.getBottom(i)); row++) {
+			for (size_t column = columnOf(store.getLeft(i)); column <= columnOf(store.getRight(i)); column++) {
+				cellEntries[fill[row * this->columns + column]++] = i;
+			}
+		}
+	}
+}
+
+int64_t UniformGrid::getCellSize() const {
+	return cellSize;
+}
+
+size_t UniformGrid::getColumnCount() const {
+	return columns;
+}
+
+size_t UniformGrid::getRowCount() const {
+	return rows;
+}
+
+size_t UniformGrid::columnOf(int64_t x) const {
+	return static_cast<size_t>((x - originX) / cellSize);
+}
+
+size_t UniformGrid::rowOf(int64_t y) const {
+	return static_cast<size_t>((y - originY) / cellSize);
+}
+
+void UniformGrid::forEachPair(const RectangleStore &store, const PairCallback &callback) const {
+	// A pair of rectangles can share several cells. It is only reported by the cell that holds the top left
+	// corner of the overlapping region.
+	IntersectionKernel::Block block;
+	IntersectionKernel::Block clipped;
+	for (size_t cell = 0; cell + 1 < cellStarts.size(); cell++) {
+		const size_t begin = cellStarts[cell];
+		const size_t end = cellStarts[cell + 1];
+
+		for (size_t a = begin; a < end; a++) {
+			const size_t first = cellEntries[a];
+			for (size_t offset = a + 1; offset < end; offset += IntersectionKernel::BLOCK_SIZE) {
+				const size_t count = std::min(IntersectionKernel::BLOCK_SIZE, end - offset);
+				for (size_t i = 0; i < count; i++) {
+					const size_t index = cellEntries[offset + i];
+					block.lefts[i] = store.getLeft(index);
+					block.tops[i] = store.getTop(index);
+					block.rights[i] = store.getRight(index);
+					block.bottoms[i] = store.getBottom(index);
+				}
+
+				const uint32_t hits = IntersectionKernel::intersect(
+				    store.getLeft(first), store.getTop(first), store.getRight(first), store.getBottom(first),
+				    block.lefts, block.tops, block.rights, block.bottoms, count, clipped);
+				for (size_t i = 0; i < count; i++) {
+					if ((hits & (1u << i)) == 0) {
+						continue;
+					}
+					if (rowOf(clipped.tops[i]) * columns + columnOf(clipped.lefts[i]) != cell) {
+						continue;
+					}
+					callback(first, cellEntries[offset + i], clipped.lefts[i], clipped.tops[i], clipped.rights[i],
+					         clipped.bottoms[i]);
+				}
+			}
+		}
+	}
+}
+
+} // namespace nitro
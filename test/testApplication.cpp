@@ -1,6 +1,8 @@
 #include "Application.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <sstream>
 
 namespace nitro {
 
@@ -147,4 +149,228 @@ TEST_F(ApplicationTest, LoadRectanglesOverridesDefault) {
     ASSERT_EQ(rectangles.size(), maxRects);
 }
 
+TEST_F(ApplicationTest, ThreadsOption) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", "--threads", "4", path, "3"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    ASSERT_TRUE(app.init(argv.size(), argv.data()));
+    ASSERT_EQ(app.threadCount, 4);
+    ASSERT_EQ(app.maxRectangles, 3);
+    ASSERT_EQ(app.run(), 0);
+}
+
+TEST_F(ApplicationTest, ThreadsOptionMissingValue) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--threads"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    int index = 2;
+    ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::MissingOptionValue);
+    ASSERT_FALSE(app.init(argv.size(), argv.data()));
+}
+
+TEST_F(ApplicationTest, ThreadsOptionInvalidValue) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--threads", "-2"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    int index = 2;
+    ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::InvalidOptionValue);
+    ASSERT_FALSE(app.init(argv.size(), argv.data()));
+}
+
+TEST_F(ApplicationTest, UnknownOption) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--fast"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    int index = 2;
+    ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::UnknownOption);
+    ASSERT_FALSE(app.init(argv.size(), argv.data()));
+}
+
+TEST_F(ApplicationTest, LimitOptions) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--max-order", "3", "--max-results", "5",
+                                     "--memory-budget", "4096"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    ASSERT_TRUE(app.init(argv.size(), argv.data()));
+    ASSERT_EQ(app.limits.maxOrder, 3);
+    ASSERT_EQ(app.limits.maxResults, 5);
+    ASSERT_EQ(app.limits.memoryBudget, 4096);
+    ASSERT_EQ(app.run(), 0);
+}
+
+TEST_F(ApplicationTest, MemoryBudgetSuffixes) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::pair<std::string, size_t>> cases = {
+        {"512", 512}, {"2K", 2048}, {"3m", 3ull << 20}, {"1G", 1ull << 30}};
+
+    for (const auto &[value, expected] : cases) {
+        std::vector<std::string> args = {"rectangle_intersect", path, "--memory-budget", value};
+        std::vector<char *> argv = createArgv(args);
+        Application app(argv.size(), argv.data());
+        ASSERT_TRUE(app.init(argv.size(), argv.data()));
+        ASSERT_EQ(app.limits.memoryBudget, expected);
+    }
+
+    for (std::string value : {"2KB", "K", "-1K", "2T"}) {
+        std::vector<std::string> args = {"rectangle_intersect", path, "--memory-budget", value};
+        std::vector<char *> argv = createArgv(args);
+        Application app(argv.size(), argv.data());
+        int index = 2;
+        ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::InvalidOptionValue);
+    }
+
+    // Suffixes only apply to sizes
+    std::vector<std::string> args = {"rectangle_intersect", path, "--max-results", "2K"};
+    std::vector<char *> argv = createArgv(args);
+    Application app(argv.size(), argv.data());
+    int index = 2;
+    ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::InvalidOptionValue);
+}
+
+TEST_F(ApplicationTest, MaxOrderMustAllowPairs) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--max-order", "1"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    int index = 2;
+    ASSERT_EQ(app.parseOption(argv.size(), argv.data(), index), Application::ErrorCode::InvalidOptionValue);
+    ASSERT_FALSE(app.init(argv.size(), argv.data()));
+}
+
+TEST_F(ApplicationTest, CountOnlyOption) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", "--count-only", path};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    ASSERT_TRUE(app.init(argv.size(), argv.data()));
+    ASSERT_EQ(app.outputMode, Application::OutputMode::Counts);
+
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(app.run(), 0);
+    std::string output = testing::internal::GetCapturedStdout();
+    ASSERT_TRUE(output.contains("Intersection counts:\n"
+                                "   2 rectangles: 5 intersections, total area 75900\n"
+                                "   3 rectangles: 2 intersections, total area 16400\n"));
+}
+
+TEST_F(ApplicationTest, CoverageOption) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--coverage"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    ASSERT_TRUE(app.init(argv.size(), argv.data()));
+    ASSERT_EQ(app.outputMode, Application::OutputMode::Coverage);
+
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(app.run(), 0);
+    std::string output = testing::internal::GetCapturedStdout();
+    ASSERT_TRUE(output.contains("Coverage:\n"
+                                "   Maximum depth: 3\n"));
+    ASSERT_TRUE(output.contains("   Regions at maximum depth:\n"
+                                "      (160, 160) w=190, h=20\n"
+                                "      (160, 200) w=210, h=60\n"));
+}
+
+TEST_F(ApplicationTest, StatisticsOption) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--statistics"};
+    std::vector<char *> argv = createArgv(args);
+
+    Application app(argv.size(), argv.data());
+    ASSERT_TRUE(app.init(argv.size(), argv.data()));
+    ASSERT_EQ(app.outputMode, Application::OutputMode::Statistics);
+
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(app.run(), 0);
+    std::string output = testing::internal::GetCapturedStdout();
+    ASSERT_TRUE(output.contains("Statistics:\n"
+                                "   Union area: 89500\n"
+                                "   Summed pairwise overlap area: 75900\n"
+                                "   Bounding box: (100, 100) w=410, h=250\n"));
+}
+
+TEST_F(ApplicationTest, TiledOption) {
+    std::string path = getPathToTestFile("test10-twelverectangles.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "12"};
+    std::vector<char *> argv = createArgv(args);
+    Application app(argv.size(), argv.data());
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(app.run(), 0);
+    std::string expected = testing::internal::GetCapturedStdout();
+
+    // Tiles change the order intersections are listed in, but not the intersections
+    std::vector<std::string> tiledArgs = {"rectangle_intersect", path, "12", "--tiled", "2"};
+    std::vector<char *> tiledArgv = createArgv(tiledArgs);
+    Application tiledApp(tiledArgv.size(), tiledArgv.data());
+    ASSERT_EQ(tiledApp.rectanglesPerTile, 2);
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(tiledApp.run(), 0);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    const auto sortedLines = [](const std::string &text) {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        for (std::string line; std::getline(stream, line);) {
+            lines.push_back(line);
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    };
+    ASSERT_EQ(sortedLines(output), sortedLines(expected));
+    ASSERT_TRUE(output.starts_with("Input:\n"));
+}
+
+TEST_F(ApplicationTest, TiledOptionOnlyListsIntersections) {
+    std::string path = getPathToTestFile("test1-specification-example.json");
+    std::vector<std::string> args = {"rectangle_intersect", path, "--tiled", "1K", "--coverage"};
+    std::vector<char *> argv = createArgv(args);
+
+    testing::internal::CaptureStderr();
+    Application app(argv.size(), argv.data());
+    std::string output = testing::internal::GetCapturedStderr();
+    ASSERT_EQ(app.rectanglesPerTile, 1024);
+    ASSERT_EQ(app.run(), 1);
+    ASSERT_TRUE(output.contains("Error: --tiled can only be used to list intersections."));
+}
+
+TEST_F(ApplicationTest, HugeCoordinatesAreMapped) {
+    std::string path = getPathToTestFile("test12-hugecoordinates.json");
+    std::vector<std::string> args = {"rectangle_intersect", path};
+    std::vector<char *> argv = createArgv(args);
+    Application app(argv.size(), argv.data());
+
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(app.run(), 0);
+    std::string output = testing::internal::GetCapturedStdout();
+    ASSERT_TRUE(app.coordinates.has_value());
+    ASSERT_EQ(output, "Input:\n"
+                      "   1: Rectangle at (100,100), w=250, h=80\n"
+                      "   2: Rectangle at (5000000000,200), w=100, h=150\n"
+                      "   3: Rectangle at (5000000050,-3000000000), w=200, h=3000000300\n"
+                      "\n"
+                      "Intersections:\n"
+                      "   Between rectangles 2 and 3 at (5000000050, 200) w=50, h=100\n");
+
+    // Areas can't be measured on the ranks
+    std::vector<std::string> countArgs = {"rectangle_intersect", path, "--count-only"};
+    std::vector<char *> countArgv = createArgv(countArgs);
+    Application countApp(countArgv.size(), countArgv.data());
+    testing::internal::CaptureStderr();
+    ASSERT_EQ(countApp.run(), 1);
+    ASSERT_TRUE(testing::internal::GetCapturedStderr().contains("can only be used to list intersections"));
+}
+
 } // namespace nitro
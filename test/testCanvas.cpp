@@ -1,9 +1,22 @@
 #include "Canvas.hpp"
+#include "IdSetTable.hpp"
 #include "RectangleIntersection.hpp"
 #include <gtest/gtest.h>
 #include <cmath>
+#include <map>
+#include <random>
 namespace nitro {
 
+// Members and shape of every intersection, in order, which is what two ways of finding them must agree on
+template <typename Intersections>
+static std::vector<std::pair<std::set<Rectangle::ID>, Rectangle>> describe(const Intersections &intersections) {
+    std::vector<std::pair<std::set<Rectangle::ID>, Rectangle>> result;
+    for (const Canvas::RectangleIntersection &intersection : intersections) {
+        result.push_back({intersection.getIntersectingRectangles(), intersection.getShape()});
+    }
+    return result;
+}
+
 class CanvasTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -11,6 +24,32 @@ protected:
 
     void TearDown() override {
     }
+
+public:
+    // Rectangles with IDs 1 to count, at positions in [-spread, spread] and with extents in [0, maxExtent].
+    // A rectangle drawn as a point gets a height of 1.
+    static std::vector<Rectangle> randomRectangles(unsigned seed, size_t count, int spread = 500,
+                                                   uint32_t maxExtent = 120) {
+        std::mt19937 generator{seed};
+        std::uniform_int_distribution<int> position{-spread, spread};
+        std::uniform_int_distribution<uint32_t> extent{0, maxExtent};
+
+        std::vector<Rectangle> rectangles;
+        for (Rectangle::ID id = 1; id <= count; id++) {
+            const int x = position(generator);
+            const int y = position(generator);
+            const uint32_t width = extent(generator);
+            const uint32_t height = extent(generator);
+            rectangles.push_back({id, {x, y}, width, width == 0 && height == 0 ? 1 : height});
+        }
+        return rectangles;
+    }
+
+    // Same intersections in the same order, from any two containers of them
+    template <typename Actual, typename Expected>
+    static void expectSameIntersections(const Actual &actual, const Expected &expected) {
+        EXPECT_EQ(describe(actual), describe(expected));
+    }
 };
 
 TEST(CanvasTest, CreateFromVec) {
@@ -214,6 +253,376 @@ TEST(CanvasTest, PairwiseIntersectionZeroRectangles) {
     ASSERT_FALSE(interRet.has_value());
 }
 
+TEST(CanvasTest, PairwiseSweepLineMatchesBruteForce) {
+    Canvas canvas{CanvasTest::randomRectangles(42, 200)};
+    canvas.setPairwiseEngine(Canvas::PairwiseEngine::BruteForce);
+    std::set<Canvas::RectangleIntersection> expected = canvas.determinePairwiseIntersectionsBruteForce();
+    ASSERT_FALSE(expected.empty());
+
+    CanvasTest::expectSameIntersections(canvas.determinePairwiseIntersectionsSweepLine(), expected);
+}
+
+TEST(CanvasTest, PairwiseGridMatchesBruteForce) {
+    Canvas canvas{CanvasTest::randomRectangles(11, 200)};
+    std::set<Canvas::RectangleIntersection> expected = canvas.determinePairwiseIntersectionsBruteForce();
+    ASSERT_FALSE(expected.empty());
+
+    // Automatic, tiny and huge cells
+    for (int64_t cellSize : {UniformGrid::AUTOMATIC_CELL_SIZE, int64_t{7}, int64_t{5000}}) {
+        canvas.setGridCellSize(cellSize);
+        CanvasTest::expectSameIntersections(canvas.determinePairwiseIntersectionsGrid(), expected);
+    }
+}
+
+TEST(CanvasTest, PairwiseRTreeMatchesBruteForce) {
+    // Clustered input: dense hot spots with empty space in between
+    std::mt19937 generator{5};
+    std::uniform_int_distribution<int> hotSpot{-5000, 5000};
+    std::uniform_int_distribution<int> offset{-60, 60};
+    std::uniform_int_distribution<int> extent{0, 40};
+
+    std::vector<Rectangle> rectangles;
+    for (int cluster = 0; cluster < 6; cluster++) {
+        const int x = hotSpot(generator);
+        const int y = hotSpot(generator);
+        for (int i = 0; i < 50; i++) {
+            uint32_t width = extent(generator);
+            uint32_t height = extent(generator) + 1;
+            Rectangle::ID id = static_cast<Rectangle::ID>(rectangles.size() + 1);
+            rectangles.push_back({id, {x + offset(generator), y + offset(generator)}, width, height});
+        }
+    }
+
+    Canvas canvas{rectangles};
+    std::set<Canvas::RectangleIntersection> expected = canvas.determinePairwiseIntersectionsBruteForce();
+    ASSERT_FALSE(expected.empty());
+
+    CanvasTest::expectSameIntersections(canvas.determinePairwiseIntersectionsRTree(), expected);
+}
+
+TEST(CanvasTest, PairwiseParallelMatchesSweepLine) {
+    Canvas canvas{CanvasTest::randomRectangles(23, 1000, 2000, 300)};
+    std::set<Canvas::RectangleIntersection> expected = canvas.determinePairwiseIntersectionsSweepLine();
+    ASSERT_FALSE(expected.empty());
+
+    for (size_t threads : {2, 3, 8}) {
+        canvas.setThreadCount(threads);
+        ASSERT_EQ(canvas.getThreadCount(), threads);
+        CanvasTest::expectSameIntersections(canvas.determinePairwiseIntersectionsParallel(), expected);
+    }
+}
+
+// test/test_plots/T8RectsOnlyTouchingCorners.png
+TEST(CanvasTest, PairwiseSweepLineTouchingEdgesDoNotIntersect) {
+    std::vector<Rectangle> rectangles{{1, {-160, -160}, 80, 80},
+                                      {2, {-80, -80}, 80, 80},
+                                      {3, {-80, -160}, 80, 80},
+                                      {4, {-160, -80}, 80, 80},
+                                      {5, {-120, -120}, 0, 80}};
+
+    Canvas canvas{rectangles};
+    canvas.setPairwiseEngine(Canvas::PairwiseEngine::SweepLine);
+
+    std::optional<std::set<Canvas::RectangleIntersection>> interRet = canvas.determinePairwiseIntersections();
+    ASSERT_FALSE(interRet.has_value());
+}
+
+TEST(CanvasTest, CanvasesShareAThreadPool) {
+    std::vector<Rectangle> rectangles = CanvasTest::randomRectangles(53, 200);
+    const std::vector<Canvas::RectangleIntersection> expected = Canvas{rectangles}.intersectAll();
+
+    std::shared_ptr<ThreadPool> threadPool = std::make_shared<ThreadPool>(4);
+    for (int i = 0; i < 3; i++) {
+        Canvas canvas{rectangles};
+        canvas.setThreadPool(threadPool);
+        ASSERT_EQ(canvas.getThreadCount(), 4);
+        CanvasTest::expectSameIntersections(canvas.intersectAll(), expected);
+    }
+    ASSERT_EQ(threadPool.use_count(), 1);
+
+    Canvas serial{rectangles};
+    serial.setThreadPool(nullptr);
+    ASSERT_EQ(serial.getThreadCount(), 1);
+}
+
+TEST(CanvasTest, NeighborRestrictedMatchesExhaustive) {
+    Canvas canvas{CanvasTest::randomRectangles(7, 40, 150, 90)};
+    std::optional<std::set<Canvas::RectangleIntersection>> pairwise = canvas.determinePairwiseIntersections();
+    ASSERT_TRUE(pairwise.has_value());
+
+    std::set<Canvas::RectangleIntersection> expected = canvas.determineAllIntersectionsExhaustive(pairwise.value());
+    ASSERT_GT(expected.size(), pairwise.value().size());
+    CanvasTest::expectSameIntersections(canvas.determineAllIntersectionsNeighborRestricted(pairwise.value()), expected);
+}
+
+TEST(CanvasTest, ParallelEnumerationMatchesSerial) {
+    Canvas canvas{CanvasTest::randomRectangles(29, 40, 150, 90)};
+    std::set<Canvas::RectangleIntersection> pairwise = canvas.determinePairwiseIntersections().value();
+    std::set<Canvas::RectangleIntersection> expected = canvas.determineAllIntersectionsNeighborRestricted(pairwise);
+
+    canvas.setThreadCount(4);
+    CanvasTest::expectSameIntersections(canvas.determineAllIntersectionsNeighborRestricted(pairwise), expected);
+    CanvasTest::expectSameIntersections(canvas.determineAllIntersectionsExhaustive(pairwise), expected);
+}
+
+TEST(CanvasTest, StreamIntersectionsMatchesIntersectAll) {
+    Canvas canvas{CanvasTest::randomRectangles(31, 40, 150, 90)};
+    std::vector<Canvas::RectangleIntersection> expected = canvas.intersectAll();
+    ASSERT_FALSE(expected.empty());
+    ASSERT_GT(expected.back().getMemberCount(), 3);
+
+    // Levels are expanded on the thread pool, with either strategy, and still streamed in order
+    for (size_t threadCount : {1, 4}) {
+        for (Canvas::EnumerationStrategy strategy :
+             {Canvas::EnumerationStrategy::NeighborRestricted, Canvas::EnumerationStrategy::Exhaustive}) {
+            canvas.setThreadCount(threadCount);
+            canvas.setEnumerationStrategy(strategy);
+
+            std::vector<Canvas::RectangleIntersection> streamed;
+            canvas.streamIntersections(
+                [&](const Canvas::RectangleIntersection &intersection) { streamed.push_back(intersection); });
+            CanvasTest::expectSameIntersections(streamed, expected);
+        }
+    }
+}
+
+TEST(CanvasTest, StreamIntersectionsWhileStopsWhenAsked) {
+    Canvas canvas{CanvasTest::randomRectangles(31, 40, 150, 90)};
+    const std::vector<Canvas::RectangleIntersection> all = canvas.intersectAll();
+
+    // Stops in the middle of the pairwise intersections and of a higher level alike
+    for (size_t wanted : {size_t{3}, all.size() - 2}) {
+        std::vector<Canvas::RectangleIntersection> streamed;
+        const Canvas::LimitReached limitReached =
+            canvas.streamIntersectionsWhile([&](const Canvas::RectangleIntersection &intersection) {
+                streamed.push_back(intersection);
+                return streamed.size() < wanted;
+            });
+        ASSERT_EQ(limitReached, Canvas::LimitReached::MaxResults);
+        CanvasTest::expectSameIntersections(streamed, std::vector(all.begin(), all.begin() + wanted));
+    }
+}
+
+TEST(CanvasTest, StreamIntersectionsWithoutIntersections) {
+    std::vector<Rectangle> rectangles{{1, {-160, -160}, 80, 80},
+                                      {2, {-80, -80}, 80, 80}};
+    Canvas canvas{rectangles};
+
+    size_t streamed = 0;
+    canvas.streamIntersections([&](const Canvas::RectangleIntersection &) { streamed++; });
+    ASSERT_EQ(streamed, 0);
+}
+
+TEST(CanvasTest, MaxOrderLimit) {
+    // Six nested rectangles: every combination of them intersects
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 6; id++) {
+        const int offset = static_cast<int>(id) * 5;
+        rectangles.push_back({id, {offset, offset}, 200 - 10 * id, 200 - 10 * id});
+    }
+
+    for (Canvas::EnumerationStrategy strategy :
+         {Canvas::EnumerationStrategy::NeighborRestricted, Canvas::EnumerationStrategy::Exhaustive}) {
+        Canvas canvas{rectangles};
+        canvas.setEnumerationStrategy(strategy);
+        ASSERT_EQ(canvas.intersectAll().size(), 57);
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::None);
+
+        canvas.setLimits({.maxOrder = 3});
+        std::vector<Canvas::RectangleIntersection> limited = canvas.intersectAll();
+        ASSERT_EQ(limited.size(), 15 + 20);
+        ASSERT_EQ(limited.back().getMemberCount(), 3);
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::MaxOrder);
+
+        size_t streamed = 0;
+        ASSERT_EQ(canvas.streamIntersections([&](const Canvas::RectangleIntersection &) { streamed++; }),
+                  Canvas::LimitReached::MaxOrder);
+        ASSERT_EQ(streamed, limited.size());
+
+        // The deepest intersection fits, so no limit is reached
+        canvas.setLimits({.maxOrder = 6});
+        ASSERT_EQ(canvas.intersectAll().size(), 57);
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::None);
+        ASSERT_EQ(canvas.streamIntersections([](const Canvas::RectangleIntersection &) {}),
+                  Canvas::LimitReached::None);
+    }
+
+    Canvas canvas{rectangles};
+    EXPECT_THROW(canvas.setLimits({.maxOrder = 1}), std::invalid_argument);
+}
+
+TEST(CanvasTest, MaxResultsLimit) {
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 6; id++) {
+        const int offset = static_cast<int>(id) * 5;
+        rectangles.push_back({id, {offset, offset}, 200 - 10 * id, 200 - 10 * id});
+    }
+
+    Canvas reference{rectangles};
+    std::vector<Canvas::RectangleIntersection> all = reference.intersectAll();
+
+    for (size_t maxResults : {10, 20, 40, 57}) {
+        for (Canvas::EnumerationStrategy strategy :
+             {Canvas::EnumerationStrategy::NeighborRestricted, Canvas::EnumerationStrategy::Exhaustive}) {
+            Canvas canvas{rectangles};
+            canvas.setEnumerationStrategy(strategy);
+            canvas.setThreadCount(3);
+            canvas.setLimits({.maxResults = maxResults});
+            const Canvas::LimitReached expectedLimit =
+                maxResults < all.size() ? Canvas::LimitReached::MaxResults : Canvas::LimitReached::None;
+
+            std::vector<Canvas::RectangleIntersection> limited = canvas.intersectAll();
+            ASSERT_EQ(limited.size(), maxResults);
+            ASSERT_EQ(canvas.getLimitReached(), expectedLimit);
+            for (size_t i = 0; i < limited.size(); i++) {
+                ASSERT_EQ(limited[i].getIntersectingRectangles(), all[i].getIntersectingRectangles());
+            }
+
+            std::vector<Canvas::RectangleIntersection> streamed;
+            ASSERT_EQ(canvas.streamIntersections(
+                          [&](const Canvas::RectangleIntersection &intersection) { streamed.push_back(intersection); }),
+                      expectedLimit);
+            ASSERT_EQ(streamed.size(), maxResults);
+            for (size_t i = 0; i < streamed.size(); i++) {
+                ASSERT_EQ(streamed[i].getIntersectingRectangles(), all[i].getIntersectingRectangles());
+            }
+        }
+    }
+}
+
+TEST(CanvasTest, MemoryBudgetLimit) {
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 12; id++) {
+        const int offset = static_cast<int>(id) * 5;
+        rectangles.push_back({id, {offset, offset}, 200 - 10 * id, 200 - 10 * id});
+    }
+
+    for (Canvas::EnumerationStrategy strategy :
+         {Canvas::EnumerationStrategy::NeighborRestricted, Canvas::EnumerationStrategy::Exhaustive}) {
+        Canvas canvas{rectangles};
+        canvas.setEnumerationStrategy(strategy);
+
+        // The pairwise intersections are always kept
+        canvas.setLimits({.memoryBudget = 1});
+        ASSERT_EQ(canvas.intersectAll().size(), 66);
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::MemoryBudget);
+        size_t streamed = 0;
+        ASSERT_EQ(canvas.streamIntersections([&](const Canvas::RectangleIntersection &) { streamed++; }),
+                  Canvas::LimitReached::MemoryBudget);
+        ASSERT_EQ(streamed, 66);
+
+        // A level that doesn't fit is dropped as a whole
+        canvas.setLimits({.memoryBudget = 64 * 1024});
+        std::vector<Canvas::RectangleIntersection> limited = canvas.intersectAll();
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::MemoryBudget);
+        ASSERT_GT(limited.size(), 66);
+        ASSERT_LT(limited.size(), 4096 - 13);
+        std::map<size_t, size_t> countPerOrder;
+        for (const Canvas::RectangleIntersection &intersection : limited) {
+            countPerOrder[intersection.getMemberCount()]++;
+        }
+        for (const auto &[order, count] : countPerOrder) {
+            // Binomial coefficient of 12 over order
+            size_t expected = 1;
+            for (size_t k = 1; k <= order; k++) {
+                expected = expected * (12 - k + 1) / k;
+            }
+            ASSERT_EQ(count, expected);
+        }
+
+        canvas.setLimits({.memoryBudget = 64 * 1024 * 1024});
+        ASSERT_EQ(canvas.intersectAll().size(), 4096 - 13);
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::None);
+    }
+}
+
+TEST(CanvasTest, MemoryBudgetCoversStreamedLevels) {
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 12; id++) {
+        const int offset = static_cast<int>(id) * 5;
+        rectangles.push_back({id, {offset, offset}, 200 - 10 * id, 200 - 10 * id});
+    }
+
+    for (Canvas::EnumerationStrategy strategy :
+         {Canvas::EnumerationStrategy::NeighborRestricted, Canvas::EnumerationStrategy::Exhaustive}) {
+        Canvas canvas{rectangles};
+        canvas.setEnumerationStrategy(strategy);
+        canvas.setThreadCount(2);
+
+        // Streaming holds the levels being expanded, not every intersection, so it gets further on the same budget
+        canvas.setLimits({.memoryBudget = 384 * 1024});
+        const size_t kept = canvas.intersectAll().size();
+        ASSERT_EQ(canvas.getLimitReached(), Canvas::LimitReached::MemoryBudget);
+        size_t streamed = 0;
+        ASSERT_EQ(canvas.streamIntersections([&](const Canvas::RectangleIntersection &) { streamed++; }),
+                  Canvas::LimitReached::None);
+        ASSERT_EQ(streamed, 4096 - 13);
+        ASSERT_LT(kept, streamed);
+
+        // A level that doesn't fit is still dropped as a whole
+        canvas.setLimits({.memoryBudget = 96 * 1024});
+        std::map<size_t, size_t> countPerOrder;
+        ASSERT_EQ(canvas.streamIntersections([&](const Canvas::RectangleIntersection &intersection) {
+            countPerOrder[intersection.getMemberCount()]++;
+        }),
+                  Canvas::LimitReached::MemoryBudget);
+        ASSERT_GT(countPerOrder.size(), 1);
+        ASSERT_LT(countPerOrder.size(), 11);
+        for (const auto &[order, count] : countPerOrder) {
+            size_t expected = 1;
+            for (size_t k = 1; k <= order; k++) {
+                expected = expected * (12 - k + 1) / k;
+            }
+            ASSERT_EQ(count, expected);
+        }
+    }
+}
+
+TEST(CanvasTest, CountIntersectionsMatchesIntersectAll) {
+    const std::vector<Rectangle> rectangles = CanvasTest::randomRectangles(37, 50, 150, 120);
+
+    Canvas reference{rectangles};
+    std::map<size_t, std::pair<uint64_t, uint64_t>> expected;
+    for (const Canvas::RectangleIntersection &intersection : reference.intersectAll()) {
+        const Rectangle shape = intersection.getShape();
+        expected[intersection.getMemberCount()].first++;
+        expected[intersection.getMemberCount()].second += static_cast<uint64_t>(shape.getWidth()) * shape.getHeight();
+    }
+    ASSERT_GT(expected.size(), 2);
+
+    for (Canvas::PairwiseEngine engine : {Canvas::PairwiseEngine::BruteForce, Canvas::PairwiseEngine::SweepLine,
+                                          Canvas::PairwiseEngine::Grid, Canvas::PairwiseEngine::RTree}) {
+        for (size_t threads : {1, 4}) {
+            Canvas canvas{rectangles};
+            canvas.setPairwiseEngine(engine);
+            canvas.setThreadCount(threads);
+
+            std::vector<Canvas::OrderSummary> summary = canvas.countIntersections();
+            ASSERT_EQ(summary.size(), expected.size());
+            for (const Canvas::OrderSummary &order : summary) {
+                ASSERT_EQ(order.count, expected[order.order].first);
+                ASSERT_EQ(order.area, expected[order.order].second);
+            }
+        }
+    }
+
+    Canvas limited{rectangles};
+    limited.setLimits({.maxOrder = 3});
+    std::vector<Canvas::OrderSummary> summary = limited.countIntersections();
+    ASSERT_EQ(summary.size(), 2);
+    ASSERT_EQ(summary[1].order, 3);
+    ASSERT_EQ(summary[1].count, expected[3].first);
+}
+
+TEST(CanvasTest, CountIntersectionsWithoutIntersections) {
+    Canvas empty;
+    ASSERT_TRUE(empty.countIntersections().empty());
+
+    std::vector<Rectangle> rectangles{{1, {0, 0}, 10, 10}, {2, {10, 0}, 10, 10}};
+    Canvas touching{rectangles};
+    ASSERT_TRUE(touching.countIntersections().empty());
+}
+
 TEST(CanvasTest, IntersectAllWithOneRectangle) {
     std::vector<Rectangle> rectangles{{1, {100, 100}, 250, 80}};
 
@@ -534,4 +943,261 @@ TEST(CanvasTest, IntersectFifteenOverlappingRectanglesMeetsSizeExpectation) {
     ASSERT_EQ(intersections.size(), std::pow(2, 15) - 1 - 15);
 }
 
+
+TEST(CanvasTest, InsertReturnsNewIntersections) {
+    std::vector<Rectangle> rectangles{{1, {100, 100}, 250, 80},
+                                      {2, {120, 200}, 250, 150},
+                                      {3, {140, 160}, 250, 100}};
+    Canvas canvas{rectangles};
+
+    std::vector<Canvas::RectangleIntersection> added = canvas.insert({4, {160, 140}, 350, 190});
+    std::vector<std::set<Rectangle::ID>> expected{{1, 4}, {2, 4}, {3, 4}, {1, 3, 4}, {2, 3, 4}};
+    ASSERT_EQ(added.size(), expected.size());
+    for (size_t i = 0; i < added.size(); i++) {
+        ASSERT_EQ(added[i].getIntersectingRectangles(), expected[i]);
+    }
+    ASSERT_EQ(added[0].getShape(), Rectangle(1, {160, 140}, 190, 40));
+
+    ASSERT_THROW(canvas.insert({4, {0, 0}, 1, 1}), std::invalid_argument);
+    ASSERT_TRUE(canvas.insert({5, {1000, 1000}, 10, 10}).empty());
+    ASSERT_EQ(canvas.getRectangles().size(), 5);
+}
+
+TEST(CanvasTest, EraseReturnsRemovedIntersections) {
+    std::vector<Rectangle> rectangles{{1, {100, 100}, 250, 80},
+                                      {2, {140, 160}, 250, 100},
+                                      {3, {10, 20}, 250, 140},
+                                      {4, {160, 140}, 350, 190}};
+    Canvas canvas{rectangles};
+    const std::vector<Canvas::RectangleIntersection> before = canvas.intersectAll();
+
+    std::vector<Canvas::RectangleIntersection> removed = canvas.erase(2);
+    ASSERT_THROW(canvas.erase(2), std::invalid_argument);
+    for (const Canvas::RectangleIntersection &intersection : removed) {
+        ASSERT_TRUE(intersection.contains(2));
+    }
+    ASSERT_EQ(canvas.intersectAll().size() + removed.size(), before.size());
+}
+
+TEST(CanvasTest, EditsMatchRebuild) {
+    std::vector<Rectangle> rectangles = CanvasTest::randomRectangles(41, 30, 300, 150);
+    Canvas canvas{rectangles};
+
+    // Picks the edits and the inserted rectangles
+    std::mt19937 generator{41};
+    std::uniform_int_distribution<int> position{-300, 300};
+    std::uniform_int_distribution<uint32_t> extent{1, 150};
+    std::vector<Canvas::RectangleIntersection> current = canvas.intersectAll();
+
+    for (int edit = 0; edit < 60; edit++) {
+        std::vector<Canvas::RectangleIntersection> expected;
+        std::vector<Canvas::RectangleIntersection> delta;
+        if (edit % 3 == 0) {
+            // Erasing keeps the intersections without the erased rectangle
+            const Rectangle::ID id = rectangles[generator() % rectangles.size()].getId();
+            delta = canvas.erase(id);
+            std::erase_if(rectangles, [id](const Rectangle &rectangle) { return rectangle.getId() == id; });
+            std::copy_if(current.begin(), current.end(), std::back_inserter(expected),
+                         [id](const Canvas::RectangleIntersection &intersection) { return intersection.contains(id); });
+        } else {
+            // New IDs go both below and above the existing ones
+            const Rectangle rectangle{static_cast<Rectangle::ID>(edit % 2 == 0 ? 100 + edit : 100 - edit),
+                                      {position(generator), position(generator)},
+                                      extent(generator),
+                                      extent(generator)};
+            delta = canvas.insert(rectangle);
+            rectangles.push_back(rectangle);
+            const std::vector<Canvas::RectangleIntersection> after = Canvas{rectangles}.intersectAll();
+            std::copy_if(after.begin(), after.end(), std::back_inserter(expected),
+                         [&](const Canvas::RectangleIntersection &intersection) {
+                             return intersection.contains(rectangle.getId());
+                         });
+        }
+        std::sort(expected.begin(), expected.end());
+        CanvasTest::expectSameIntersections(delta, expected);
+
+        // Streaming runs on the edited, unordered store while intersectAll restores the order
+        std::vector<Canvas::RectangleIntersection> streamed;
+        canvas.streamIntersections(
+            [&](const Canvas::RectangleIntersection &intersection) { streamed.push_back(intersection); });
+        current = canvas.intersectAll();
+        CanvasTest::expectSameIntersections(current, Canvas{rectangles}.intersectAll());
+        CanvasTest::expectSameIntersections(streamed, current);
+    }
+}
+
+TEST(CanvasTest, QueryPointAndWindow) {
+    std::vector<Rectangle> rectangles{{1, {100, 100}, 250, 80},
+                                      {2, {120, 200}, 250, 150},
+                                      {3, {140, 160}, 250, 100},
+                                      {4, {160, 140}, 350, 190}};
+    Canvas canvas{rectangles};
+
+    ASSERT_EQ(canvas.queryPoint(200, 170), (std::vector<Rectangle::ID>{1, 3, 4}));
+    ASSERT_EQ(canvas.queryPoint(100, 100), (std::vector<Rectangle::ID>{1}));
+    ASSERT_TRUE(canvas.queryPoint(0, 0).empty());
+    ASSERT_EQ(canvas.queryWindow({1, {0, 0}, 120, 300}), (std::vector<Rectangle::ID>{1, 2}));
+    ASSERT_TRUE(canvas.queryWindow({1, {600, 0}, 10, 10}).empty());
+
+    // Queries follow edits, and windows only need some valid ID
+    canvas.erase(1);
+    canvas.insert({5, {0, 0}, 200, 200});
+    ASSERT_EQ(canvas.queryPoint(100, 100), (std::vector<Rectangle::ID>{5}));
+    ASSERT_EQ(canvas.queryPoint(200, 170), (std::vector<Rectangle::ID>{3, 4, 5}));
+    canvas.setGridCellSize(5);
+    ASSERT_EQ(canvas.queryPoint(200, 170), (std::vector<Rectangle::ID>{3, 4, 5}));
+    canvas.intersectAll();
+    ASSERT_EQ(canvas.queryWindow({1, {0, 0}, 120, 300}), (std::vector<Rectangle::ID>{2, 5}));
+}
+
+TEST(CanvasTest, QueriesMatchBruteForce) {
+    const std::vector<Rectangle> rectangles = CanvasTest::randomRectangles(43, 300);
+    Canvas canvas{rectangles};
+
+    // Query windows are drawn like the rectangles
+    std::mt19937 generator{43};
+    std::uniform_int_distribution<int> position{-500, 500};
+    std::uniform_int_distribution<uint32_t> extent{1, 120};
+
+    for (int query = 0; query < 100; query++) {
+        const Rectangle window{1, {position(generator), position(generator)}, extent(generator), extent(generator)};
+        const Rectangle::Vertices bounds = window.getVertices();
+
+        std::vector<Rectangle::ID> covering;
+        std::vector<Rectangle::ID> touching;
+        for (const Rectangle &rectangle : rectangles) {
+            const Rectangle::Vertices vertices = rectangle.getVertices();
+            if (vertices.topLeft.x <= bounds.topLeft.x && bounds.topLeft.x <= vertices.bottomRight.x &&
+                vertices.topLeft.y <= bounds.topLeft.y && bounds.topLeft.y <= vertices.bottomRight.y) {
+                covering.push_back(rectangle.getId());
+            }
+            if (vertices.topLeft.x <= bounds.bottomRight.x && bounds.topLeft.x <= vertices.bottomRight.x &&
+                vertices.topLeft.y <= bounds.bottomRight.y && bounds.topLeft.y <= vertices.bottomRight.y) {
+                touching.push_back(rectangle.getId());
+            }
+        }
+        ASSERT_EQ(canvas.queryPoint(bounds.topLeft.x, bounds.topLeft.y), covering);
+        ASSERT_EQ(canvas.queryWindow(window), touching);
+    }
+}
+
+TEST(CanvasTest, QueryBatchKeepsQueryOrder) {
+    Canvas canvas{CanvasTest::randomRectangles(47, 300)};
+    canvas.setThreadCount(4);
+
+    std::mt19937 generator{47};
+    std::uniform_int_distribution<int> position{-500, 500};
+    std::uniform_int_distribution<uint32_t> extent{0, 120};
+
+    std::vector<Canvas::Query> queries;
+    std::vector<std::vector<Rectangle::ID>> expected;
+    for (int query = 0; query < 500; query++) {
+        if (query % 2 == 0) {
+            const int x = position(generator);
+            const int y = position(generator);
+            queries.push_back(Canvas::Query::point(x, y));
+            expected.push_back(canvas.queryPoint(x, y));
+        } else {
+            const Rectangle window{1, {position(generator), position(generator)}, extent(generator) + 1,
+                                   extent(generator) + 1};
+            queries.push_back(Canvas::Query::window(window));
+            expected.push_back(canvas.queryWindow(window));
+        }
+    }
+
+    ASSERT_EQ(canvas.queryBatch(queries), expected);
+    ASSERT_TRUE(canvas.queryBatch({}).empty());
+}
+
+TEST(CanvasTest, JoinReportsCrossPairsOnly) {
+    // Rectangles 1 and 2 of the first canvas overlap, and the second canvas reuses their IDs
+    Canvas first{std::vector<Rectangle>{{1, {0, 0}, 100, 100}, {2, {50, 50}, 100, 100}, {3, {500, 500}, 10, 10}}};
+    Canvas second{std::vector<Rectangle>{{1, {90, 90}, 20, 20}, {2, {0, 100}, 10, 10}, {7, {-50, -50}, 60, 60}}};
+    first.setThreadCount(2);
+
+    std::vector<Canvas::JoinPair> pairs = first.join(second);
+    ASSERT_EQ(pairs.size(), 3);
+    ASSERT_EQ(pairs[0].first, 1);
+    ASSERT_EQ(pairs[0].second, 1);
+    ASSERT_EQ(pairs[0].shape, Rectangle(1, {90, 90}, 10, 10));
+    ASSERT_EQ(pairs[1].first, 1);
+    ASSERT_EQ(pairs[1].second, 7);
+    ASSERT_EQ(pairs[1].shape, Rectangle(1, {0, 0}, 10, 10));
+    ASSERT_EQ(pairs[2].first, 2);
+    ASSERT_EQ(pairs[2].second, 1);
+    ASSERT_EQ(pairs[2].shape, Rectangle(1, {90, 90}, 20, 20));
+
+    ASSERT_TRUE(first.join(Canvas{}).empty());
+}
+
+TEST(CanvasTest, LevelAllocationsAreCounted) {
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 8; id++) {
+        rectangles.push_back({id, {static_cast<int>(id), static_cast<int>(id)}, 100, 100});
+    }
+    Canvas canvas{rectangles};
+    canvas.intersectAll();
+
+    // Every subset of 2 to 8 rectangles intersects, the deepest level has no candidates to extend
+    const std::vector<Canvas::LevelAllocations> &levels = canvas.getLevelAllocations();
+    ASSERT_EQ(levels.size(), 7);
+    uint64_t allocations = 0;
+    uint64_t blocks = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+        ASSERT_EQ(levels[i].order, i + 2);
+        ASSERT_GT(levels[i].allocations, 0);
+        ASSERT_GT(levels[i].bytes, 0);
+        ASSERT_LE(levels[i].blocks, levels[i].allocations);
+        allocations += levels[i].allocations;
+        blocks += levels[i].blocks;
+    }
+    // The arenas serve many requests out of each heap block
+    ASSERT_LT(blocks * 4, allocations);
+
+    // What remains on the heap is the result: one copy of the spilled IDs per kept intersection, and its growth
+    const uint64_t binomial[] = {28, 56, 70, 56, 28, 8, 1};
+    uint64_t growth = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const size_t order = levels[i].order;
+        const uint64_t spilled = order > Canvas::RectangleIntersection::INLINE_MEMBERS ? binomial[i] : 0;
+        ASSERT_GE(levels[i].heapAllocations, spilled);
+        ASSERT_GE(levels[i].heapBytes, spilled * order * sizeof(Rectangle::ID));
+        growth += levels[i].heapAllocations - spilled;
+    }
+    ASSERT_GT(growth, 0);
+    ASSERT_LT(growth, 16);
+
+    canvas.setEnumerationStrategy(Canvas::EnumerationStrategy::Exhaustive);
+    canvas.intersectAll();
+    ASSERT_TRUE(canvas.getLevelAllocations().empty());
+}
+
+TEST(CanvasTest, IdSetStatisticsAreAggregated) {
+    std::vector<Rectangle> rectangles;
+    for (Rectangle::ID id = 1; id <= 8; id++) {
+        rectangles.push_back({id, {static_cast<int>(id), static_cast<int>(id)}, 100, 100});
+    }
+    Canvas canvas{rectangles};
+    canvas.setThreadCount(4);
+    canvas.setEnumerationStrategy(Canvas::EnumerationStrategy::Exhaustive);
+    const std::vector<Canvas::RectangleIntersection> all = canvas.intersectAll();
+    ASSERT_EQ(all.size(), 256 - 9);
+
+    // Every combination of 3 to 8 rectangles is recorded once, and found again from each of its other subsets
+    const Canvas::IdSetStatistics &statistics = canvas.getIdSetStatistics();
+    ASSERT_EQ(statistics.entries, all.size() - 28);
+    ASSERT_GT(statistics.lookups, statistics.entries);
+    ASSERT_GE(statistics.capacity, statistics.entries);
+    ASSERT_GT(statistics.loadFactor, 0.0);
+    ASSERT_LE(statistics.loadFactor, IdSetTable::MAX_LOAD_PERCENT / 100.0);
+    ASSERT_GE(statistics.averageProbeLength, 1.0);
+    ASSERT_GE(statistics.maxProbeLength, 1);
+    ASSERT_LE(statistics.collisions, statistics.lookups);
+
+    canvas.setEnumerationStrategy(Canvas::EnumerationStrategy::NeighborRestricted);
+    canvas.intersectAll();
+    ASSERT_EQ(canvas.getIdSetStatistics().lookups, 0);
+    ASSERT_EQ(canvas.getIdSetStatistics().entries, 0);
+}
+
 } // namespace nitro
@@ -0,0 +1,64 @@
+#include "CoordinateMap.hpp"
+#include "Canvas.hpp"
+#include "RectangleIntersection.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+TEST(CoordinateMapTest, FitsOnlyThe32BitRange) {
+	ASSERT_TRUE(CoordinateMap::fits({-2147483648LL, -10, 2147483647LL, 10}));
+	ASSERT_FALSE(CoordinateMap::fits({-2147483649LL, -10, 0, 10}));
+	ASSERT_FALSE(CoordinateMap::fits({0, -10, 2147483648LL, 10}));
+	ASSERT_FALSE(CoordinateMap::fits({0, 5000000000LL, 10, 5000000100LL}));
+}
+
+TEST(CoordinateMapTest, CompressKeepsTheOrderOfEdges) {
+	const std::vector<WideBox> boxes{{5000000000LL, -7000000000LL, 5000000100LL, 10},
+	                                 {5000000050LL, 0, 9000000000LL, 10},
+	                                 {-1, -1, 5000000000LL, 0}};
+	CoordinateMap coordinates{boxes};
+
+	// x edges: -1, 5000000000, 5000000050, 5000000100, 9000000000; y edges: -7000000000, -1, 0, 10
+	ASSERT_EQ(coordinates.compress(1, boxes[0]), Rectangle(1, {1, 0}, 2, 3));
+	ASSERT_EQ(coordinates.compress(2, boxes[1]), Rectangle(2, {2, 2}, 2, 1));
+	ASSERT_EQ(coordinates.compress(3, boxes[2]), Rectangle(3, {0, 1}, 1, 1));
+	for (size_t i = 0; i < boxes.size(); i++) {
+		ASSERT_EQ(coordinates.expand(coordinates.compress(1, boxes[i]).getBox()), boxes[i]);
+	}
+}
+
+TEST(CoordinateMapTest, RanksKeepTheIntersections) {
+	std::mt19937 generator{61};
+	std::uniform_int_distribution<int> position{-300, 300};
+	std::uniform_int_distribution<uint32_t> extent{1, 90};
+
+	// The same rectangles, spread far beyond 32 bits without changing the order of their edges
+	const auto spread = [](int64_t coordinate) { return coordinate * 40000000 + 3000000000LL; };
+	std::vector<Rectangle> rectangles;
+	std::vector<WideBox> boxes;
+	for (Rectangle::ID id = 1; id <= 80; id++) {
+		rectangles.push_back({id, {position(generator), position(generator)}, extent(generator), extent(generator)});
+		const Box &box = rectangles.back().getBox();
+		boxes.push_back({spread(box.left), spread(box.top), spread(box.right), spread(box.bottom)});
+	}
+
+	CoordinateMap coordinates{boxes};
+	std::vector<Rectangle> ranks;
+	for (size_t i = 0; i < boxes.size(); i++) {
+		ranks.push_back(coordinates.compress(rectangles[i].getId(), boxes[i]));
+	}
+
+	const std::vector<Canvas::RectangleIntersection> expected = Canvas{rectangles}.intersectAll();
+	const std::vector<Canvas::RectangleIntersection> mapped = Canvas{ranks}.intersectAll();
+	ASSERT_FALSE(expected.empty());
+	ASSERT_EQ(mapped.size(), expected.size());
+	for (size_t i = 0; i < expected.size(); i++) {
+		ASSERT_EQ(mapped[i].getIntersectingRectangles(), expected[i].getIntersectingRectangles());
+		const Box &box = expected[i].getShapeRef().getBox();
+		ASSERT_EQ(coordinates.expand(mapped[i].getShapeRef().getBox()),
+		          (WideBox{spread(box.left), spread(box.top), spread(box.right), spread(box.bottom)}));
+	}
+}
+
+} // namespace nitro
@@ -0,0 +1,35 @@
+#include "CountingResource.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace nitro {
+
+TEST(CountingResourceTest, CountsRequests) {
+	CountingResource counter;
+	{
+		std::pmr::vector<uint64_t> values{&counter};
+		values.reserve(8);
+		values.reserve(32);
+	}
+	ASSERT_EQ(counter.getAllocationCount(), 2);
+	ASSERT_EQ(counter.getAllocatedBytes(), 40 * sizeof(uint64_t));
+}
+
+TEST(CountingResourceTest, CountsArenaBlocks) {
+	// Behind a monotonic arena, only the blocks the arena takes from upstream are counted
+	CountingResource blocks;
+	std::pmr::monotonic_buffer_resource arena{1024, &blocks};
+	CountingResource requests{&arena};
+
+	for (int i = 0; i < 100; i++) {
+		ASSERT_NE(requests.allocate(8, alignof(uint64_t)), nullptr);
+	}
+	ASSERT_EQ(requests.getAllocationCount(), 100);
+	ASSERT_EQ(requests.getAllocatedBytes(), 800);
+	ASSERT_EQ(blocks.getAllocationCount(), 1);
+
+	arena.release();
+	ASSERT_EQ(blocks.getAllocationCount(), 1);
+}
+
+} // namespace nitro
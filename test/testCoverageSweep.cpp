@@ -0,0 +1,160 @@
+#include "CoverageSweep.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+TEST(CoverageSweepTest, EmptyStore) {
+	RectangleStore store;
+	CoverageSweep coverage{store};
+	ASSERT_EQ(coverage.getMaxDepth(), 0);
+	ASSERT_TRUE(coverage.getMaxDepthRegions().empty());
+	ASSERT_EQ(coverage.computeAreaByDepth(store), std::vector<uint64_t>{0});
+}
+
+TEST(CoverageSweepTest, SpecificationExample) {
+	RectangleStore store;
+	store.push_back({1, {100, 100}, 250, 80});
+	store.push_back({2, {120, 200}, 250, 150});
+	store.push_back({3, {140, 160}, 250, 100});
+	store.push_back({4, {160, 140}, 350, 190});
+
+	CoverageSweep coverage{store};
+	ASSERT_EQ(coverage.getMaxDepth(), 3);
+
+	// Rectangles 1, 3 and 4 overlap at (160, 160) w=190, h=20 and 2, 3 and 4 at (160, 200) w=210, h=60
+	const std::vector<CoverageSweep::Region> &regions = coverage.getMaxDepthRegions();
+	ASSERT_EQ(regions.size(), 2);
+	ASSERT_EQ(regions[0].left, 160);
+	ASSERT_EQ(regions[0].top, 160);
+	ASSERT_EQ(regions[0].right, 350);
+	ASSERT_EQ(regions[0].bottom, 180);
+	ASSERT_EQ(regions[1].left, 160);
+	ASSERT_EQ(regions[1].top, 200);
+	ASSERT_EQ(regions[1].right, 370);
+	ASSERT_EQ(regions[1].bottom, 260);
+
+	std::vector<uint64_t> areas = coverage.computeAreaByDepth(store);
+	ASSERT_EQ(areas.size(), 4);
+	ASSERT_EQ(areas[3], 190 * 20 + 210 * 60);
+
+	// The pairwise intersections of the example add up to 75900
+	CoverageSweep::Statistics statistics = CoverageSweep::computeStatistics(store);
+	ASSERT_EQ(statistics.unionArea, areas[1] + areas[2] + areas[3]);
+	ASSERT_EQ(statistics.overlapArea, 75900);
+	ASSERT_TRUE(statistics.boundingBox.has_value());
+	ASSERT_EQ(statistics.boundingBox->left, 100);
+	ASSERT_EQ(statistics.boundingBox->top, 100);
+	ASSERT_EQ(statistics.boundingBox->right, 510);
+	ASSERT_EQ(statistics.boundingBox->bottom, 350);
+}
+
+TEST(CoverageSweepTest, StatisticsOfEmptyStore) {
+	RectangleStore store;
+	store.push_back({1, {0, 0}, 0, 10});
+	CoverageSweep::Statistics statistics = CoverageSweep::computeStatistics(store);
+	ASSERT_EQ(statistics.unionArea, 0);
+	ASSERT_EQ(statistics.overlapArea, 0);
+	ASSERT_FALSE(statistics.boundingBox.has_value());
+}
+
+TEST(CoverageSweepTest, TouchingAndLineRectanglesAddNoDepth) {
+	RectangleStore store;
+	store.push_back({1, {0, 0}, 10, 10});
+	store.push_back({2, {10, 0}, 10, 10});
+	store.push_back({3, {5, 0}, 0, 10});
+
+	CoverageSweep coverage{store};
+	ASSERT_EQ(coverage.getMaxDepth(), 1);
+	// Both squares are reported, merged along y where they touch
+	ASSERT_EQ(coverage.getMaxDepthRegions().size(), 1);
+	ASSERT_EQ(coverage.getMaxDepthRegions()[0].left, 0);
+	ASSERT_EQ(coverage.getMaxDepthRegions()[0].right, 20);
+	ASSERT_EQ(coverage.computeAreaByDepth(store), (std::vector<uint64_t>{0, 200}));
+}
+
+TEST(CoverageSweepTest, DeeplyNestedSquares) {
+	// Square d lies inside the d - 1 squares before it, so depth d is the ring between squares d and d + 1
+	const size_t count = 3000;
+	RectangleStore store;
+	for (Rectangle::ID id = 1; id <= count; id++) {
+		const uint32_t side = static_cast<uint32_t>(2 * (count - id + 1));
+		store.push_back({id, {static_cast<int>(id), static_cast<int>(id)}, side, side});
+	}
+
+	CoverageSweep coverage{store};
+	ASSERT_EQ(coverage.getMaxDepth(), count);
+	const std::vector<uint64_t> areas = coverage.computeAreaByDepth(store);
+	ASSERT_EQ(areas.size(), count + 1);
+	for (size_t depth = 1; depth < count; depth++) {
+		const uint64_t outer = 2 * (count - depth + 1);
+		const uint64_t inner = outer - 2;
+		ASSERT_EQ(areas[depth], outer * outer - inner * inner);
+	}
+	ASSERT_EQ(areas[count], 4);
+}
+
+TEST(CoverageSweepTest, MatchesPixelCount) {
+	std::mt19937 generator{41};
+	std::uniform_int_distribution<int> position{0, 40};
+	std::uniform_int_distribution<int> extent{0, 25};
+
+	RectangleStore store;
+	for (Rectangle::ID id = 1; id <= 60; id++) {
+		store.push_back({id, {position(generator), position(generator)}, static_cast<uint32_t>(extent(generator)),
+		                 static_cast<uint32_t>(extent(generator))});
+	}
+
+	// Every unit pixel of the canvas is covered by the rectangles that contain it
+	std::vector<std::vector<size_t>> depth(70, std::vector<size_t>(70, 0));
+	for (size_t i = 0; i < store.size(); i++) {
+		for (int y = store.getTop(i); y < store.getBottom(i); y++) {
+			for (int x = store.getLeft(i); x < store.getRight(i); x++) {
+				depth[y][x]++;
+			}
+		}
+	}
+	size_t maxDepth = 0;
+	for (const std::vector<size_t> &row : depth) {
+		maxDepth = std::max(maxDepth, *std::max_element(row.begin(), row.end()));
+	}
+	std::vector<uint64_t> expectedAreas(maxDepth + 1, 0);
+	uint64_t maxDepthArea = 0;
+	for (const std::vector<size_t> &row : depth) {
+		for (size_t d : row) {
+			if (d > 0) {
+				expectedAreas[d]++;
+			}
+			maxDepthArea += d == maxDepth ? 1 : 0;
+		}
+	}
+
+	CoverageSweep coverage{store};
+	ASSERT_EQ(coverage.getMaxDepth(), maxDepth);
+	ASSERT_EQ(coverage.computeAreaByDepth(store), expectedAreas);
+
+	uint64_t regionArea = 0;
+	for (const CoverageSweep::Region &region : coverage.getMaxDepthRegions()) {
+		regionArea += static_cast<uint64_t>(region.right - region.left) * (region.bottom - region.top);
+		for (int y = region.top; y < region.bottom; y++) {
+			for (int x = region.left; x < region.right; x++) {
+				ASSERT_EQ(depth[y][x], maxDepth);
+			}
+		}
+	}
+	ASSERT_EQ(regionArea, maxDepthArea);
+
+	uint64_t unionArea = 0;
+	uint64_t overlapArea = 0;
+	for (const std::vector<size_t> &row : depth) {
+		for (size_t d : row) {
+			unionArea += d > 0 ? 1 : 0;
+			overlapArea += d * (d - (d > 0 ? 1 : 0)) / 2;
+		}
+	}
+	CoverageSweep::Statistics statistics = CoverageSweep::computeStatistics(store);
+	ASSERT_EQ(statistics.unionArea, unionArea);
+	ASSERT_EQ(statistics.overlapArea, overlapArea);
+}
+
+} // namespace nitro
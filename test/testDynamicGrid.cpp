@@ -0,0 +1,92 @@
+#include "DynamicGrid.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+class DynamicGridTest : public ::testing::Test {
+	protected:
+		void SetUp() override {
+			store.push_back({1, {0, 0}, 100, 100});
+			store.push_back({2, {50, 50}, 100, 100});
+			store.push_back({3, {300, 300}, 20, 20});
+			store.push_back({4, {100, 0}, 50, 60});
+		}
+
+		std::vector<size_t> bruteForceWindow(int left, int top, int right, int bottom) const {
+			std::vector<size_t> result;
+			for (size_t i = 0; i < store.size(); i++) {
+				if (store.getLeft(i) <= right && left <= store.getRight(i) && store.getTop(i) <= bottom &&
+				    top <= store.getBottom(i)) {
+					result.push_back(i);
+				}
+			}
+			return result;
+		}
+
+		RectangleStore store;
+};
+
+TEST_F(DynamicGridTest, AutomaticCellSizeFollowsMeanExtent) {
+	DynamicGrid grid{store};
+	// (100 + 100 + 20 + 55) / 4
+	ASSERT_EQ(grid.getCellSize(), 68);
+
+	RectangleStore empty;
+	ASSERT_EQ(DynamicGrid{empty}.getCellSize(), DynamicGrid::DEFAULT_CELL_SIZE);
+}
+
+TEST_F(DynamicGridTest, QueryWindowIncludesEdges) {
+	DynamicGrid grid{store, 25};
+
+	ASSERT_EQ(grid.queryWindow(store, 75, 75, 75, 75), (std::vector<size_t>{0, 1}));
+	ASSERT_EQ(grid.queryWindow(store, 100, 20, 100, 20), (std::vector<size_t>{0, 3}));
+	ASSERT_EQ(grid.queryWindow(store, -100, -100, 1000, 1000), (std::vector<size_t>{0, 1, 2, 3}));
+	ASSERT_TRUE(grid.queryWindow(store, 400, 400, 500, 500).empty());
+}
+
+TEST_F(DynamicGridTest, OversizedRectanglesAreFound) {
+	DynamicGrid grid{store, 10};
+	store.push_back({5, {-5000, -5000}, 10000, 10000});
+	grid.insert(5, -5000, -5000, 5000, 5000);
+
+	ASSERT_EQ(grid.queryWindow(store, 2000, 2000, 2000, 2000), (std::vector<size_t>{4}));
+	ASSERT_EQ(grid.queryWindow(store, 310, 310, 310, 310), (std::vector<size_t>{2, 4}));
+
+	grid.erase(5, -5000, -5000, 5000, 5000);
+	store.erase(4);
+	ASSERT_TRUE(grid.queryWindow(store, 2000, 2000, 2000, 2000).empty());
+}
+
+TEST_F(DynamicGridTest, EditsMatchBruteForce) {
+	DynamicGrid grid{store, 16};
+
+	std::mt19937 generator{19};
+	std::uniform_int_distribution<int> position{-500, 500};
+	std::uniform_int_distribution<int> extent{0, 120};
+	std::uniform_int_distribution<uint32_t> size{0, 120};
+	Rectangle::ID nextId = 5;
+	for (int edit = 0; edit < 400; edit++) {
+		if (store.size() > 2 && generator() % 3 == 0) {
+			const size_t index = generator() % store.size();
+			grid.erase(store.getId(index), store.getLeft(index), store.getTop(index), store.getRight(index),
+			           store.getBottom(index));
+			store.erase(index);
+		} else {
+			const Rectangle rectangle{nextId++, {position(generator), position(generator)}, size(generator),
+			                          size(generator)};
+			store.push_back(rectangle);
+			const size_t index = store.size() - 1;
+			grid.insert(rectangle.getId(), store.getLeft(index), store.getTop(index), store.getRight(index),
+			            store.getBottom(index));
+		}
+
+		const int left = position(generator);
+		const int top = position(generator);
+		const int right = left + extent(generator);
+		const int bottom = top + extent(generator);
+		ASSERT_EQ(grid.queryWindow(store, left, top, right, bottom), bruteForceWindow(left, top, right, bottom));
+	}
+}
+
+} // namespace nitro
@@ -0,0 +1,64 @@
+#include "IdSetTable.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace nitro {
+
+TEST(IdSetTableTest, InsertDeduplicates) {
+	IdSetTable table;
+	std::vector<Rectangle::ID> first{1, 2, 3};
+	std::vector<Rectangle::ID> second{1, 2, 4};
+
+	ASSERT_TRUE(table.empty());
+	ASSERT_TRUE(table.insert(first));
+	ASSERT_TRUE(table.insert(second));
+	ASSERT_FALSE(table.insert(first));
+	ASSERT_EQ(table.size(), 2);
+	ASSERT_TRUE(table.contains(second));
+	ASSERT_FALSE(table.contains(std::vector<Rectangle::ID>{1, 2}));
+}
+
+TEST(IdSetTableTest, PrefixesAreDistinct) {
+	IdSetTable table;
+	ASSERT_TRUE(table.insert(std::vector<Rectangle::ID>{}));
+	ASSERT_TRUE(table.insert(std::vector<Rectangle::ID>{5}));
+	ASSERT_TRUE(table.insert(std::vector<Rectangle::ID>{5, 6}));
+	ASSERT_FALSE(table.insert(std::vector<Rectangle::ID>{}));
+	ASSERT_EQ(table.size(), 3);
+}
+
+TEST(IdSetTableTest, GrowsAndKeepsEntries) {
+	IdSetTable table;
+	for (Rectangle::ID id = 1; id <= 5000; id++) {
+		ASSERT_TRUE(table.insert(std::vector<Rectangle::ID>{id, id + 1, id + 7}));
+	}
+
+	ASSERT_EQ(table.size(), 5000);
+	ASSERT_GT(table.getCapacity(), IdSetTable::INITIAL_CAPACITY);
+	ASSERT_LE(table.getLoadFactor(), IdSetTable::MAX_LOAD_PERCENT / 100.0);
+	for (Rectangle::ID id = 1; id <= 5000; id++) {
+		ASSERT_TRUE(table.contains(std::vector<Rectangle::ID>{id, id + 1, id + 7}));
+		ASSERT_FALSE(table.contains(std::vector<Rectangle::ID>{id, id + 2, id + 7}));
+	}
+}
+
+TEST(IdSetTableTest, ProbeCounters) {
+	IdSetTable table;
+	ASSERT_EQ(table.getLookupCount(), 0);
+	ASSERT_EQ(table.getAverageProbeLength(), 0.0);
+
+	for (Rectangle::ID id = 1; id <= 100; id++) {
+		table.insert(std::vector<Rectangle::ID>{id, id + 1});
+	}
+	ASSERT_EQ(table.getLookupCount(), 100);
+	ASSERT_GE(table.getAverageProbeLength(), 1.0);
+	ASSERT_GE(table.getMaxProbeLength(), 1);
+	ASSERT_EQ(table.getCollisionCount(), 0);
+
+	table.clear();
+	ASSERT_TRUE(table.empty());
+	ASSERT_EQ(table.getLookupCount(), 0);
+	ASSERT_EQ(table.getCapacity(), 0);
+}
+
+} // namespace nitro
@@ -0,0 +1,80 @@
+#include "IntersectionKernel.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+TEST(IntersectionKernelTest, ReportsHitsAndClippedBoxes) {
+	// Overlapping, touching, disjoint, contained and line candidates
+	IntersectionKernel::Block candidates{{50, 100, 200, 20, 60, 0, 0, 0},
+	                                     {50, 0, 0, 20, 0, 0, 0, 0},
+	                                     {150, 120, 250, 30, 60, 0, 0, 0},
+	                                     {150, 100, 100, 30, 100, 0, 0, 0}};
+	IntersectionKernel::Block clipped;
+
+	uint32_t mask = IntersectionKernel::intersect(0, 0, 100, 100, candidates.lefts, candidates.tops, candidates.rights,
+	                                              candidates.bottoms, 5, clipped);
+
+	ASSERT_EQ(mask, 0b01001);
+	ASSERT_EQ(clipped.lefts[0], 50);
+	ASSERT_EQ(clipped.tops[0], 50);
+	ASSERT_EQ(clipped.rights[0], 100);
+	ASSERT_EQ(clipped.bottoms[0], 100);
+	ASSERT_EQ(clipped.lefts[3], 20);
+	ASSERT_EQ(clipped.tops[3], 20);
+	ASSERT_EQ(clipped.rights[3], 30);
+	ASSERT_EQ(clipped.bottoms[3], 30);
+}
+
+TEST(IntersectionKernelTest, MatchesScalarImplementation) {
+	std::mt19937 generator{3};
+	std::uniform_int_distribution<int> position{-200, 200};
+	std::uniform_int_distribution<int> extent{0, 150};
+
+	// Every implementation the processor can run, not only the one picked by intersect()
+	using InstructionSet = IntersectionKernel::InstructionSet;
+	ASSERT_TRUE(IntersectionKernel::isSupported(InstructionSet::Scalar));
+	for (InstructionSet instructionSet : {InstructionSet::Scalar, InstructionSet::SSE41, InstructionSet::AVX2}) {
+		if (!IntersectionKernel::isSupported(instructionSet)) {
+			continue;
+		}
+
+		for (size_t count = 0; count <= IntersectionKernel::BLOCK_SIZE; count++) {
+			IntersectionKernel::Block candidates;
+			for (size_t i = 0; i < count; i++) {
+				candidates.lefts[i] = position(generator);
+				candidates.tops[i] = position(generator);
+				candidates.rights[i] = candidates.lefts[i] + extent(generator);
+				candidates.bottoms[i] = candidates.tops[i] + extent(generator);
+			}
+
+			IntersectionKernel::Block expected;
+			IntersectionKernel::Block actual;
+			IntersectionKernel::Block dispatched;
+			uint32_t expectedMask =
+			    IntersectionKernel::intersectScalar(-50, -50, 60, 70, candidates.lefts, candidates.tops,
+			                                        candidates.rights, candidates.bottoms, count, expected);
+			uint32_t actualMask =
+			    IntersectionKernel::intersectWith(instructionSet, -50, -50, 60, 70, candidates.lefts, candidates.tops,
+			                                      candidates.rights, candidates.bottoms, count, actual);
+			uint32_t dispatchedMask = IntersectionKernel::intersect(-50, -50, 60, 70, candidates.lefts, candidates.tops,
+			                                                        candidates.rights, candidates.bottoms, count,
+			                                                        dispatched);
+
+			ASSERT_EQ(actualMask, expectedMask) << static_cast<int>(instructionSet);
+			ASSERT_EQ(dispatchedMask, expectedMask) << IntersectionKernel::getInstructionSet();
+			for (size_t i = 0; i < count; i++) {
+				if ((expectedMask & (1u << i)) != 0) {
+					ASSERT_EQ(actual.lefts[i], expected.lefts[i]);
+					ASSERT_EQ(actual.tops[i], expected.tops[i]);
+					ASSERT_EQ(actual.rights[i], expected.rights[i]);
+					ASSERT_EQ(actual.bottoms[i], expected.bottoms[i]);
+					ASSERT_EQ(dispatched.lefts[i], expected.lefts[i]);
+					ASSERT_EQ(dispatched.bottoms[i], expected.bottoms[i]);
+				}
+			}
+		}
+	}
+}
+
+} // namespace nitro
@@ -257,4 +257,84 @@ TEST_F(JsonHandlerTest, UnMarshalDefinePointShouldFail) {
 	}
 }
 
-} // namespace nitro
\ No newline at end of file
+TEST_F(JsonHandlerTest, UnMarshalHugeCoordinatesShouldFail) {
+    std::string filePath = getPathToTestFile("test12-hugecoordinates.json");
+    JsonHandler jsonHandler;
+    ASSERT_TRUE(jsonHandler.loadFile(filePath));
+
+    std::optional<json> j = jsonHandler.getArray("rects").value();
+    ASSERT_TRUE(j.has_value());
+
+    try {
+		JsonHandler::unmarshal<std::vector<Rectangle>>(j.value());
+		FAIL();
+	} catch (const std::runtime_error &e) {
+		EXPECT_STREQ(e.what(), "Rectangle coordinates exceed the supported range: 5000000000");
+	}
+	EXPECT_THROW(JsonHandler::streamRectangles(filePath, "rects", 100, [](const Rectangle &) {}), std::runtime_error);
+	// Only the rectangles before the out of range one are read
+	EXPECT_EQ(JsonHandler::streamRectangles(filePath, "rects", 1, [](const Rectangle &) {}), 1);
+}
+
+TEST_F(JsonHandlerTest, UnMarshalHugeCoordinatesAsWideBoxes) {
+    std::string filePath = getPathToTestFile("test12-hugecoordinates.json");
+    JsonHandler jsonHandler;
+    ASSERT_TRUE(jsonHandler.loadFile(filePath));
+
+    std::optional<std::vector<WideBox>> boxes =
+        JsonHandler::unmarshal<std::vector<WideBox>>(jsonHandler.getArray("rects"));
+    ASSERT_TRUE(boxes.has_value());
+    ASSERT_EQ(boxes.value().size(), 3);
+    ASSERT_EQ(boxes.value()[0], (WideBox{100, 100, 350, 180}));
+    ASSERT_EQ(boxes.value()[1], (WideBox{5000000000LL, 200, 5000000100LL, 350}));
+    ASSERT_EQ(boxes.value()[2], (WideBox{5000000050LL, -3000000000LL, 5000000250LL, 300}));
+
+    // Edges must still fit in 64 bits
+    json outOfRange = {{"x", std::numeric_limits<int64_t>::max() - 5}, {"y", 0}, {"w", 10}, {"h", 10}};
+    EXPECT_THROW(JsonHandler::unmarshal<WideBox>(outOfRange), std::runtime_error);
+    json unsignedOutOfRange = {{"x", std::numeric_limits<uint64_t>::max()}, {"y", 0}, {"w", 10}, {"h", 10}};
+    EXPECT_THROW(JsonHandler::unmarshal<WideBox>(unsignedOutOfRange), std::runtime_error);
+}
+
+TEST_F(JsonHandlerTest, StreamRectanglesMatchesUnmarshal) {
+	for (const std::string filename : {"test1-specification-example.json", "test10-twelverectangles.json"}) {
+		std::string filePath = getPathToTestFile(filename);
+		JsonHandler jsonHandler;
+		jsonHandler.loadFile(filePath);
+
+		for (size_t maxSize : {0, 3, 100}) {
+			std::vector<Rectangle> expected;
+			std::optional<json> array = jsonHandler.getArray("rects", maxSize);
+			if (array.has_value() && !array.value().empty()) {
+				expected = JsonHandler::unmarshal<std::vector<Rectangle>>(array.value()).value();
+			}
+
+			std::vector<Rectangle> streamed;
+			size_t count = JsonHandler::streamRectangles(filePath, "rects", maxSize, [&](const Rectangle &rectangle) {
+				streamed.push_back(rectangle);
+			});
+			ASSERT_EQ(count, expected.size());
+			ASSERT_EQ(streamed, expected);
+			for (size_t i = 0; i < streamed.size(); i++) {
+				ASSERT_EQ(streamed[i].getId(), expected[i].getId());
+			}
+		}
+	}
+}
+
+TEST_F(JsonHandlerTest, StreamRectanglesRejectsInvalidInput) {
+	const auto stream = [this](const std::string &filename) {
+		return JsonHandler::streamRectangles(getPathToTestFile(filename), "rects", 100, [](const Rectangle &) {});
+	};
+
+	ASSERT_EQ(stream("test8-emptyarray.json"), 0);
+	ASSERT_THROW(stream("test2-empty-file.json"), std::runtime_error);
+	ASSERT_THROW(stream("test3-invalid.json"), std::runtime_error);
+	ASSERT_THROW(stream("test5-singlerect-missingfields.json"), std::runtime_error);
+	ASSERT_THROW(stream("test6-notanarray.json"), std::runtime_error);
+	ASSERT_THROW(stream("test7-keynotfound.json"), std::runtime_error);
+	ASSERT_THROW(stream("test9-invalidrect.json"), std::runtime_error);
+	ASSERT_THROW(stream("test11-defineapoint.json"), std::runtime_error);
+}
+
+} // namespace nitro
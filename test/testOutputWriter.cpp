@@ -0,0 +1,64 @@
+#include "OutputWriter.hpp"
+#include "Canvas.hpp"
+#include "Rectangle.hpp"
+#include "RectangleIntersection.hpp"
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace nitro {
+
+TEST(OutputWriterTest, FormatsNumbersAndText) {
+	std::ostringstream stream;
+	{
+		OutputWriter out{stream};
+		out << "a" << 'b' << std::string{"c"} << 0 << ' ' << -42 << ' ' << std::numeric_limits<int64_t>::min() << ' '
+		    << std::numeric_limits<uint64_t>::max() << ' ' << size_t{7};
+		ASSERT_TRUE(stream.str().empty());
+	}
+	ASSERT_EQ(stream.str(), "abc0 -42 -9223372036854775808 18446744073709551615 7");
+}
+
+TEST(OutputWriterTest, RectanglesAndIntersectionsMatchToString) {
+	// Intersections of two up to five rectangles, some spilling beyond the inline members
+	std::vector<Rectangle> rectangles{{1, {-100, -100}, 250, 80}, {2, {-140, -160}, 250, 100},
+	                                  {3, {-120, -130}, 90, 90},  {4, {-110, -110}, 30, 30},
+	                                  {5, {-105, -105}, 10, 10},  {6, {-104, -108}, 8, 6}};
+	Canvas canvas{rectangles};
+	const std::vector<Canvas::RectangleIntersection> intersections = canvas.intersectAll();
+	ASSERT_EQ(intersections.back().getMemberCount(), 5);
+
+	std::string expected;
+	std::ostringstream stream;
+	{
+		// A tiny buffer flushes in the middle of numbers and text
+		OutputWriter out{stream, 8};
+		for (const Rectangle &rectangle : rectangles) {
+			out << rectangle << '\n';
+			expected += rectangle.toString() + "\n";
+		}
+		for (const Canvas::RectangleIntersection &intersection : intersections) {
+			out << intersection << '\n';
+			expected += intersection.toString() + "\n";
+		}
+	}
+	ASSERT_EQ(stream.str(), expected);
+}
+
+TEST(OutputWriterTest, FlushWritesPendingOutput) {
+	std::ostringstream stream;
+	OutputWriter out{stream, 64};
+	out << "pending";
+	ASSERT_TRUE(stream.str().empty());
+	out.flush();
+	ASSERT_EQ(stream.str(), "pending");
+
+	// Text larger than the buffer goes straight through, after what was buffered before it
+	const std::string large(200, 'x');
+	out << "-" << large;
+	ASSERT_EQ(stream.str(), "pending-" + large);
+}
+
+} // namespace nitro
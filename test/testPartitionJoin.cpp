@@ -0,0 +1,95 @@
+#include "PartitionJoin.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <tuple>
+
+namespace nitro {
+
+class PartitionJoinTest : public ::testing::Test {
+	protected:
+		void SetUp() override {
+			std::mt19937 generator{53};
+			std::uniform_int_distribution<int> position{-1000, 1000};
+			std::uniform_int_distribution<uint32_t> extent{1, 150};
+
+			for (Rectangle::ID id = 1; id <= 400; id++) {
+				for (RectangleStore *store : {&first, &second}) {
+					store->push_back({id, {position(generator), position(generator)}, extent(generator),
+					                  extent(generator)});
+				}
+			}
+		}
+
+		using Pair = std::tuple<size_t, size_t, int, int, int, int>;
+
+		std::vector<Pair> join(size_t tileCount) const {
+			PartitionJoin partitions{first, second, tileCount};
+			std::vector<Pair> pairs;
+			for (size_t tile = 0; tile < partitions.getTileCount(); tile++) {
+				partitions.joinTile(first, second, tile,
+				                    [&](size_t a, size_t b, int left, int top, int right, int bottom) {
+					                    pairs.push_back({a, b, left, top, right, bottom});
+				                    });
+			}
+			std::sort(pairs.begin(), pairs.end());
+			return pairs;
+		}
+
+		std::vector<Pair> bruteForce() const {
+			std::vector<Pair> pairs;
+			for (size_t a = 0; a < first.size(); a++) {
+				for (size_t b = 0; b < second.size(); b++) {
+					const int left = std::max(first.getLeft(a), second.getLeft(b));
+					const int top = std::max(first.getTop(a), second.getTop(b));
+					const int right = std::min(first.getRight(a), second.getRight(b));
+					const int bottom = std::min(first.getBottom(a), second.getBottom(b));
+					if (left < right && top < bottom) {
+						pairs.push_back({a, b, left, top, right, bottom});
+					}
+				}
+			}
+			return pairs;
+		}
+
+		RectangleStore first;
+		RectangleStore second;
+};
+
+TEST_F(PartitionJoinTest, AutomaticTileCountFollowsInputSize) {
+	// 800 rectangles make 3 tiles, laid out on a 2 x 2 grid
+	PartitionJoin partitions{first, second};
+	ASSERT_EQ(partitions.getColumnCount(), 2);
+	ASSERT_EQ(partitions.getRowCount(), 2);
+	ASSERT_EQ(partitions.getTileCount(), 4);
+}
+
+TEST_F(PartitionJoinTest, EmptySideHasNoTiles) {
+	RectangleStore empty;
+	PartitionJoin partitions{first, empty};
+	ASSERT_EQ(partitions.getTileCount(), 0);
+}
+
+TEST_F(PartitionJoinTest, EachPairIsReportedOnce) {
+	const std::vector<Pair> expected = bruteForce();
+	ASSERT_FALSE(expected.empty());
+	for (size_t tileCount : {1, 4, 30, 400}) {
+		ASSERT_EQ(join(tileCount), expected);
+	}
+}
+
+TEST_F(PartitionJoinTest, TouchingRectanglesDoNotJoin) {
+	RectangleStore left;
+	RectangleStore right;
+	left.push_back({1, {0, 0}, 10, 10});
+	right.push_back({1, {10, 0}, 10, 10});
+	right.push_back({2, {0, 10}, 10, 10});
+
+	PartitionJoin partitions{left, right, 4};
+	size_t pairs = 0;
+	for (size_t tile = 0; tile < partitions.getTileCount(); tile++) {
+		partitions.joinTile(left, right, tile, [&](size_t, size_t, int, int, int, int) { pairs++; });
+	}
+	ASSERT_EQ(pairs, 0);
+}
+
+} // namespace nitro
@@ -0,0 +1,86 @@
+#include "RTree.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+class RTreeTest : public ::testing::Test {
+	protected:
+		void SetUp() override {
+			std::mt19937 generator{13};
+			std::uniform_int_distribution<int> position{-1000, 1000};
+			std::uniform_int_distribution<int> extent{0, 80};
+
+			for (Rectangle::ID id = 1; id <= 500; id++) {
+				uint32_t width = extent(generator);
+				uint32_t height = extent(generator) + 1;
+				store.push_back({id, {position(generator), position(generator)}, width, height});
+			}
+		}
+
+		std::vector<size_t> bruteForceWindow(int left, int top, int right, int bottom) const {
+			std::vector<size_t> result;
+			for (size_t i = 0; i < store.size(); i++) {
+				if (store.getLeft(i) <= right && left <= store.getRight(i) && store.getTop(i) <= bottom &&
+				    top <= store.getBottom(i)) {
+					result.push_back(i);
+				}
+			}
+			return result;
+		}
+
+		RectangleStore store;
+};
+
+TEST_F(RTreeTest, PackedLevels) {
+	RTree tree{store};
+	// 500 rectangles: 63 leaves, 8 inner nodes and the root
+	ASSERT_EQ(tree.getHeight(), 3);
+	ASSERT_EQ(tree.getNodeCount(), 72);
+}
+
+TEST_F(RTreeTest, EmptyStore) {
+	RectangleStore empty;
+	RTree tree{empty};
+	ASSERT_EQ(tree.getNodeCount(), 0);
+	ASSERT_TRUE(tree.queryPoint(0, 0).empty());
+}
+
+TEST_F(RTreeTest, QueriesMatchBruteForce) {
+	RTree tree{store};
+
+	std::mt19937 generator{17};
+	std::uniform_int_distribution<int> position{-1100, 1100};
+	std::uniform_int_distribution<int> extent{0, 300};
+	for (int query = 0; query < 200; query++) {
+		const int x = position(generator);
+		const int y = position(generator);
+		ASSERT_EQ(tree.queryPoint(x, y), bruteForceWindow(x, y, x, y));
+
+		const int right = x + extent(generator);
+		const int bottom = y + extent(generator);
+		ASSERT_EQ(tree.queryWindow(x, y, right, bottom), bruteForceWindow(x, y, right, bottom));
+	}
+}
+
+TEST_F(RTreeTest, EachPairIsReportedOnce) {
+	RTree tree{store};
+
+	std::vector<std::pair<size_t, size_t>> pairs;
+	tree.forEachPair(store, [&](size_t first, size_t second, int, int, int, int) { pairs.push_back({first, second}); });
+
+	std::vector<std::pair<size_t, size_t>> expected;
+	for (size_t i = 0; i < store.size(); i++) {
+		for (size_t j = i + 1; j < store.size(); j++) {
+			if (Rectangle::intersection(store.at(i), store.at(j)).has_value()) {
+				expected.push_back({i, j});
+			}
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	ASSERT_FALSE(expected.empty());
+	ASSERT_EQ(pairs, expected);
+}
+
+} // namespace nitro
@@ -19,6 +19,14 @@ TEST(RectangleTest, IdCantBeZero) {
 	}
 }
 
+TEST(RectangleTest, ExtentsBeyondIntMax) {
+	Rectangle rectangle{1, {-2000000000, -2100000000}, 4000000000u, std::numeric_limits<uint32_t>::max() - 100000000};
+	ASSERT_EQ(rectangle.getWidth(), 4000000000u);
+	ASSERT_EQ(rectangle.getHeight(), std::numeric_limits<uint32_t>::max() - 100000000);
+	ASSERT_EQ(rectangle.getRight(), 2000000000);
+	ASSERT_EQ(rectangle.getBottom(), 2094967295);
+}
+
 TEST(RectangleTest, CreateFromTopLeftStoresInputCorrectly) {
 	Rectangle rectangle{1, {100, 100}, 250, 80};
 	ASSERT_EQ(rectangle.getVertices().topLeft.x, 100);
@@ -46,6 +54,28 @@ TEST(RectangleTest, CreateFromTopLeftGeneratesCorrectVertices) {
 	ASSERT_EQ(rectangle.getVertices().topRight.y, 100);
 }
 
+TEST(RectangleTest, EdgeGettersMatchVertices) {
+	Rectangle rectangle{1, {100, 100}, 250, 80};
+	const Box &box = rectangle.getBox();
+	ASSERT_EQ(&box, &rectangle.getBox());
+	ASSERT_EQ(rectangle.getLeft(), 100);
+	ASSERT_EQ(rectangle.getTop(), 100);
+	ASSERT_EQ(rectangle.getRight(), 350);
+	ASSERT_EQ(rectangle.getBottom(), 180);
+	ASSERT_EQ(box.right, rectangle.getVertices().bottomRight.x);
+}
+
+TEST(RectangleTest, FromBoxMatchesCheckedConstruction) {
+	Rectangle checked{7, {-20, 15}, 30, 0};
+	Rectangle unchecked = Rectangle::fromBox(7, {-20, 15, 10, 15});
+	ASSERT_EQ(checked, unchecked);
+	ASSERT_EQ(unchecked.getId(), 7);
+	ASSERT_EQ(unchecked.getWidth(), 30);
+	ASSERT_EQ(unchecked.getHeight(), 0);
+	ASSERT_EQ(unchecked.getVertices().bottomLeft.y, 15);
+	ASSERT_LE(sizeof(Rectangle), sizeof(Rectangle::ID) + sizeof(Box));
+}
+
 TEST(RectangleTest, CantChangeVerticesAfterCreationDirectly) {
 	Rectangle rectangle{1, {100, 100}, 250, 80};
 	Rectangle::Vertices vertices = rectangle.getVertices();
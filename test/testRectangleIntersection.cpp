@@ -1,7 +1,11 @@
 #include "RectangleIntersection.hpp"
 #include "Rectangle.hpp"
 #include "Canvas.hpp"
+#include "CountingResource.hpp"
+#include <algorithm>
 #include <gtest/gtest.h>
+#include <span>
+#include <vector>
 
 namespace nitro {
 
@@ -60,4 +64,99 @@ TEST(RectangleIntersectionTest, TestIntersectionAbstraction) {
 	ASSERT_EQ(inter.getIntersectingRectangles(), expectedMembers);
 }
 
+TEST(RectangleIntersectionTest, MembersAreKeptSorted) {
+	Rectangle shape{Rectangle::ID_UNDEFINED, {0, 0}, 10, 10};
+	Canvas::RectangleIntersection pair{shape, 7, 3};
+	ASSERT_EQ(pair.getMemberCount(), 2);
+	ASSERT_EQ(pair.getRectIdAtIndex(0), 3);
+	ASSERT_EQ(pair.getRectIdAtIndex(1), 7);
+
+	Canvas::RectangleIntersection triple{shape, pair, 5};
+	std::vector<Rectangle::ID> expected{3, 5, 7};
+	ASSERT_TRUE(std::ranges::equal(triple.getMembers(), expected));
+	ASSERT_TRUE(triple.contains(5));
+	ASSERT_FALSE(triple.contains(4));
+	ASSERT_EQ(triple.toString(), "Between rectangles 3, 5 and 7 at (0, 0) w=10, h=10");
+}
+
+TEST(RectangleIntersectionTest, MembersSpillBeyondInlineCapacity) {
+	Rectangle shape{Rectangle::ID_UNDEFINED, {0, 0}, 10, 10};
+	std::vector<Rectangle::ID> ids{1, 2, 3, 4, 5, 6};
+	ASSERT_GT(ids.size(), Canvas::RectangleIntersection::INLINE_MEMBERS);
+
+	Canvas::RectangleIntersection intersection{shape, std::span<const Rectangle::ID>{ids}};
+	Canvas::RectangleIntersection extended{shape, intersection, 9};
+	Canvas::RectangleIntersection copy = extended;
+
+	std::vector<Rectangle::ID> expected{1, 2, 3, 4, 5, 6, 9};
+	ASSERT_TRUE(std::ranges::equal(copy.getMembers(), expected));
+	ASSERT_EQ(copy.getIntersectingRectangles(), std::set<Rectangle::ID>(expected.begin(), expected.end()));
+	ASSERT_EQ(copy.getRectIdAtIndex(6), 9);
+	EXPECT_THROW(copy.getRectIdAtIndex(7), std::out_of_range);
+}
+
+TEST(RectangleIntersectionTest, MovingLeavesNoMembers) {
+	Rectangle shape{Rectangle::ID_UNDEFINED, {0, 0}, 10, 10};
+	std::vector<Rectangle::ID> ids{1, 2, 3, 4, 5, 6};
+	Canvas::RectangleIntersection spilled{shape, std::span<const Rectangle::ID>{ids}};
+
+	Canvas::RectangleIntersection moved{std::move(spilled)};
+	ASSERT_TRUE(std::ranges::equal(moved.getMembers(), ids));
+	ASSERT_EQ(spilled.getMemberCount(), 0);
+	ASSERT_TRUE(spilled.getMembers().empty());
+	ASSERT_TRUE(spilled.getIntersectingRectangles().empty());
+
+	Canvas::RectangleIntersection assigned{shape, 7, 3};
+	assigned = std::move(moved);
+	ASSERT_TRUE(std::ranges::equal(assigned.getMembers(), ids));
+	ASSERT_EQ(moved.getMemberCount(), 0);
+	ASSERT_TRUE(moved.getMembers().empty());
+
+	// Inline members move the same way
+	Canvas::RectangleIntersection pair{shape, 7, 3};
+	assigned = std::move(pair);
+	ASSERT_EQ(assigned.getMemberCount(), 2);
+	ASSERT_EQ(assigned.getRectIdAtIndex(1), 7);
+	ASSERT_EQ(pair.getMemberCount(), 0);
+}
+
+TEST(RectangleIntersectionTest, AssignmentLeavesTheArena) {
+	Rectangle shape{Rectangle::ID_UNDEFINED, {0, 0}, 10, 10};
+	std::vector<Rectangle::ID> ids{1, 2, 3, 4, 5};
+	Canvas::RectangleIntersection base{shape, std::span<const Rectangle::ID>{ids}};
+	CountingResource arena;
+	Canvas::RectangleIntersection target{shape, base, 9, &arena};
+	const size_t arenaAllocations = arena.getAllocationCount();
+	ASSERT_GT(arenaAllocations, 0);
+
+	// A copy assigned over an arena intersection takes its IDs from the heap
+	std::vector<Rectangle::ID> copiedIds{1, 2, 3, 4, 5, 6, 7};
+	Canvas::RectangleIntersection copied{shape, std::span<const Rectangle::ID>{copiedIds}};
+	target = copied;
+	ASSERT_TRUE(std::ranges::equal(target.getMembers(), copiedIds));
+	ASSERT_TRUE(std::ranges::equal(copied.getMembers(), copiedIds));
+	ASSERT_EQ(target.spilledMembers.get_allocator().resource(), std::pmr::get_default_resource());
+
+	// A moved one keeps the heap of its source as well
+	Canvas::RectangleIntersection onArena{shape, base, 9, &arena};
+	std::vector<Rectangle::ID> movedIds{1, 2, 3, 4, 5, 6, 7, 8};
+	onArena = Canvas::RectangleIntersection{shape, std::span<const Rectangle::ID>{movedIds}};
+	ASSERT_TRUE(std::ranges::equal(onArena.getMembers(), movedIds));
+	ASSERT_EQ(onArena.spilledMembers.get_allocator().resource(), std::pmr::get_default_resource());
+	ASSERT_EQ(arena.getAllocationCount(), arenaAllocations * 2);
+}
+
+TEST(RectangleIntersectionTest, OrderingBySizeThenMembers) {
+	Rectangle shape{Rectangle::ID_UNDEFINED, {0, 0}, 10, 10};
+	Canvas::RectangleIntersection pair{shape, 5, 9};
+	Canvas::RectangleIntersection triple{shape, {1, 2, 3}};
+	Canvas::RectangleIntersection otherTriple{shape, {1, 2, 4}};
+
+	ASSERT_TRUE(pair < triple);
+	ASSERT_FALSE(triple < pair);
+	ASSERT_TRUE(triple < otherTriple);
+	ASSERT_FALSE(otherTriple < triple);
+	ASSERT_FALSE(triple < triple);
+}
+
 } // namespace nitro
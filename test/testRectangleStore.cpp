@@ -0,0 +1,76 @@
+#include "RectangleStore.hpp"
+#include <gtest/gtest.h>
+
+namespace nitro {
+
+TEST(RectangleStoreTest, PushBackStoresEdges) {
+	RectangleStore store;
+	store.push_back({1, {100, 100}, 250, 80});
+	store.push_back({2, {-40, -20}, 10, 0});
+
+	ASSERT_EQ(store.size(), 2);
+	ASSERT_EQ(store.getLeft(0), 100);
+	ASSERT_EQ(store.getTop(0), 100);
+	ASSERT_EQ(store.getRight(0), 350);
+	ASSERT_EQ(store.getBottom(0), 180);
+	ASSERT_EQ(store.getLeft(1), -40);
+	ASSERT_EQ(store.getTop(1), -20);
+	ASSERT_EQ(store.getRight(1), -30);
+	ASSERT_EQ(store.getBottom(1), -20);
+	ASSERT_EQ(store.getIds()[1], 2);
+}
+
+TEST(RectangleStoreTest, AtRebuildsRectangle) {
+	RectangleStore store;
+	Rectangle rectangle{7, {-10, 30}, 25, 40};
+	store.push_back(rectangle);
+
+	Rectangle stored = store.at(0);
+	ASSERT_EQ(stored, rectangle);
+	ASSERT_EQ(stored.getId(), 7);
+	EXPECT_THROW(store.at(1), std::out_of_range);
+}
+
+TEST(RectangleStoreTest, IndexOfFindsIds) {
+	RectangleStore store;
+	store.push_back({5, {0, 0}, 10, 10});
+	store.push_back({3, {0, 0}, 10, 10});
+
+	ASSERT_EQ(store.indexOf(5), 0);
+	ASSERT_EQ(store.indexOf(3), 1);
+	ASSERT_FALSE(store.indexOf(4).has_value());
+}
+
+TEST(RectangleStoreTest, DuplicateIdsAreRejected) {
+	RectangleStore store;
+	store.push_back({1, {0, 0}, 10, 10});
+
+	EXPECT_THROW(store.push_back({1, {5, 5}, 10, 10}), std::invalid_argument);
+	ASSERT_EQ(store.size(), 1);
+}
+
+TEST(RectangleStoreTest, EraseMovesLastRectangle) {
+	RectangleStore store;
+	store.push_back({1, {0, 0}, 10, 10});
+	store.push_back({2, {20, 0}, 10, 10});
+	store.push_back({3, {40, 0}, 10, 10});
+
+	store.erase(0);
+	ASSERT_EQ(store.size(), 2);
+	ASSERT_EQ(store.getId(0), 3);
+	ASSERT_EQ(store.getLeft(0), 40);
+	ASSERT_EQ(store.indexOf(3), 0);
+	ASSERT_EQ(store.indexOf(2), 1);
+	ASSERT_FALSE(store.indexOf(1).has_value());
+
+	store.erase(1);
+	ASSERT_EQ(store.size(), 1);
+	ASSERT_FALSE(store.indexOf(2).has_value());
+	EXPECT_THROW(store.erase(1), std::out_of_range);
+
+	// An erased ID can be used again
+	store.push_back({1, {0, 0}, 5, 5});
+	ASSERT_EQ(store.indexOf(1), 1);
+}
+
+} // namespace nitro
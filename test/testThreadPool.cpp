@@ -0,0 +1,69 @@
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace nitro {
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce) {
+	ThreadPool pool{4};
+	ASSERT_EQ(pool.getThreadCount(), 4);
+
+	std::vector<std::atomic<int>> runs(1000);
+	pool.run(runs.size(), [&](size_t task, size_t worker) {
+		ASSERT_LT(worker, 4);
+		runs[task]++;
+	});
+
+	for (const std::atomic<int> &count : runs) {
+		ASSERT_EQ(count.load(), 1);
+	}
+}
+
+TEST(ThreadPoolTest, UnevenTasksAreStolen) {
+	// The first worker's tasks are slow; the others must take some of them
+	ThreadPool pool{4};
+	std::vector<size_t> workerOf(64);
+	pool.run(workerOf.size(), [&](size_t task, size_t worker) {
+		if (task < 16) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		workerOf[task] = worker;
+	});
+
+	size_t stolen = 0;
+	for (size_t task = 0; task < 16; task++) {
+		stolen += workerOf[task] != 0 ? 1 : 0;
+	}
+	ASSERT_GT(stolen, 0);
+}
+
+TEST(ThreadPoolTest, SingleThreadRunsInline) {
+	ThreadPool pool{1};
+	std::thread::id caller = std::this_thread::get_id();
+	size_t runs = 0;
+	pool.run(10, [&](size_t, size_t worker) {
+		ASSERT_EQ(worker, 0);
+		ASSERT_EQ(std::this_thread::get_id(), caller);
+		runs++;
+	});
+	ASSERT_EQ(runs, 10);
+}
+
+TEST(ThreadPoolTest, ExceptionsAreRethrown) {
+	ThreadPool pool{3};
+	EXPECT_THROW(pool.run(20,
+	                      [](size_t task, size_t) {
+		                      if (task == 7) {
+			                      throw std::runtime_error("task failed");
+		                      }
+	                      }),
+	             std::runtime_error);
+
+	// The pool stays usable
+	std::atomic<size_t> runs{0};
+	pool.run(5, [&](size_t, size_t) { runs++; });
+	ASSERT_EQ(runs.load(), 5);
+}
+
+} // namespace nitro
@@ -0,0 +1,147 @@
+#include "TiledIntersector.hpp"
+#include "RectangleIntersection.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace nitro {
+
+class TiledIntersectorTest : public ::testing::Test {
+	protected:
+		void SetUp() override {
+			std::mt19937 generator{59};
+			std::uniform_int_distribution<int> position{-400, 400};
+			std::uniform_int_distribution<uint32_t> extent{1, 120};
+
+			for (Rectangle::ID id = 1; id <= 150; id++) {
+				rectangles.push_back({id, {position(generator), position(generator)}, extent(generator),
+				                      extent(generator)});
+			}
+		}
+
+		using Description = std::pair<std::set<Rectangle::ID>, Rectangle>;
+
+		std::vector<Description> tiled(size_t rectanglesPerTile, const Canvas::Limits &limits,
+		                               Canvas::LimitReached &limitReached, size_t threadCount = 1) const {
+			TiledIntersector tiles{std::filesystem::temp_directory_path(), rectanglesPerTile};
+			tiles.setLimits(limits);
+			tiles.setThreadCount(threadCount);
+			for (const Rectangle &rectangle : rectangles) {
+				tiles.measure(rectangle);
+			}
+			for (const Rectangle &rectangle : rectangles) {
+				tiles.spill(rectangle);
+			}
+
+			std::vector<Description> result;
+			limitReached = tiles.streamIntersections([&](const Canvas::RectangleIntersection &intersection) {
+				result.push_back({intersection.getIntersectingRectangles(), intersection.getShape()});
+			});
+			std::sort(result.begin(), result.end(), [](const Description &a, const Description &b) {
+				return a.first.size() != b.first.size() ? a.first.size() < b.first.size() : a.first < b.first;
+			});
+			return result;
+		}
+
+		std::vector<Rectangle> rectangles;
+};
+
+TEST_F(TiledIntersectorTest, TilesMatchIntersectAll) {
+	Canvas canvas{rectangles};
+	std::vector<Description> expected;
+	for (const Canvas::RectangleIntersection &intersection : canvas.intersectAll()) {
+		expected.push_back({intersection.getIntersectingRectangles(), intersection.getShape()});
+	}
+	ASSERT_FALSE(expected.empty());
+
+	// Every tile runs on the same threads
+	for (size_t threadCount : {1, 4}) {
+		for (size_t rectanglesPerTile : {1, 10, 40, 1000}) {
+			Canvas::LimitReached limitReached = Canvas::LimitReached::None;
+			ASSERT_EQ(tiled(rectanglesPerTile, {}, limitReached, threadCount), expected);
+			ASSERT_EQ(limitReached, Canvas::LimitReached::None);
+		}
+	}
+}
+
+TEST_F(TiledIntersectorTest, MaxResultsAppliesToAllTiles) {
+	Canvas::LimitReached limitReached = Canvas::LimitReached::None;
+	ASSERT_EQ(tiled(10, {0, 25, 0}, limitReached).size(), 25);
+	ASSERT_EQ(limitReached, Canvas::LimitReached::MaxResults);
+}
+
+TEST_F(TiledIntersectorTest, MaxResultsStopsTheTileEnumeration) {
+	TiledIntersector tiles{std::filesystem::temp_directory_path(), 1000};
+	tiles.setLimits({0, 25, 0});
+	for (const Rectangle &rectangle : rectangles) {
+		tiles.measure(rectangle);
+	}
+	for (const Rectangle &rectangle : rectangles) {
+		tiles.spill(rectangle);
+	}
+	ASSERT_EQ(tiles.getTileCount(), 1);
+
+	// The only tile reports everything it finds, and stops at the first intersection past the limit
+	size_t reported = 0;
+	ASSERT_EQ(tiles.streamIntersections([&](const Canvas::RectangleIntersection &) { reported++; }),
+	          Canvas::LimitReached::MaxResults);
+	ASSERT_EQ(reported, 25);
+	ASSERT_EQ(tiles.getExaminedCount(), 26);
+	ASSERT_GT(Canvas{rectangles}.intersectAll().size(), 26);
+}
+
+TEST_F(TiledIntersectorTest, TileFilesAreRemoved) {
+	std::filesystem::path directory;
+	{
+		TiledIntersector tiles{std::filesystem::temp_directory_path(), 10};
+		directory = tiles.getDirectory();
+		for (const Rectangle &rectangle : rectangles) {
+			tiles.measure(rectangle);
+		}
+		for (const Rectangle &rectangle : rectangles) {
+			tiles.spill(rectangle);
+		}
+		// 15 tiles are laid out on a 4 x 4 grid
+		ASSERT_EQ(tiles.getTileCount(), 16);
+		ASSERT_TRUE(std::filesystem::exists(directory));
+	}
+	ASSERT_FALSE(std::filesystem::exists(directory));
+}
+
+TEST_F(TiledIntersectorTest, RecordsFollowTheExtent) {
+	TiledIntersector narrow{std::filesystem::temp_directory_path(), 10};
+	ASSERT_EQ(narrow.getRecordSize(), 0);
+	narrow.measure(rectangles[0]);
+	narrow.spill(rectangles[0]);
+	ASSERT_EQ(narrow.getRecordSize(), 12);
+
+	// Spread the rectangles far beyond 16 bits, keeping their overlaps
+	for (Rectangle &rectangle : rectangles) {
+		rectangle = Rectangle{rectangle.getId(), {rectangle.getLeft() * 5000, rectangle.getTop() * 5000},
+		                      rectangle.getWidth() * 5000, rectangle.getHeight() * 5000};
+	}
+	TiledIntersector wide{std::filesystem::temp_directory_path(), 10};
+	wide.measure(rectangles[0]);
+	wide.measure(rectangles[1]);
+	wide.spill(rectangles[0]);
+	ASSERT_EQ(wide.getRecordSize(), 20);
+
+	Canvas canvas{rectangles};
+	std::vector<Description> expected;
+	for (const Canvas::RectangleIntersection &intersection : canvas.intersectAll()) {
+		expected.push_back({intersection.getIntersectingRectangles(), intersection.getShape()});
+	}
+	Canvas::LimitReached limitReached = Canvas::LimitReached::None;
+	ASSERT_EQ(tiled(10, {}, limitReached), expected);
+}
+
+TEST_F(TiledIntersectorTest, SpillingNeedsMeasuredRectangles) {
+	TiledIntersector tiles{std::filesystem::temp_directory_path()};
+	ASSERT_THROW(tiles.spill(rectangles[0]), std::logic_error);
+
+	tiles.measure(rectangles[0]);
+	tiles.spill(rectangles[0]);
+	ASSERT_THROW(tiles.spill(rectangles[1]), std::logic_error);
+	ASSERT_THROW(tiles.measure(rectangles[1]), std::logic_error);
+}
+
+} // namespace nitro
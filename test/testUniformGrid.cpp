@@ -0,0 +1,46 @@
+#include "UniformGrid.hpp"
+#include <gtest/gtest.h>
+
+namespace nitro {
+
+class UniformGridTest : public ::testing::Test {
+	protected:
+		void SetUp() override {
+			store.push_back({1, {0, 0}, 100, 100});
+			store.push_back({2, {50, 50}, 100, 100});
+			store.push_back({3, {300, 300}, 20, 20});
+			store.push_back({4, {100, 0}, 50, 60});
+		}
+
+		RectangleStore store;
+};
+
+TEST_F(UniformGridTest, AutomaticCellSizeFollowsMeanExtent) {
+	UniformGrid grid{store};
+	// (100 + 100 + 20 + 55) / 4
+	ASSERT_EQ(grid.getCellSize(), 68);
+	ASSERT_EQ(grid.getColumnCount(), 5);
+	ASSERT_EQ(grid.getRowCount(), 5);
+}
+
+TEST_F(UniformGridTest, EachPairIsReportedOnce) {
+	UniformGrid grid{store, 10};
+
+	std::vector<std::pair<size_t, size_t>> pairs;
+	grid.forEachPair(store, [&](size_t first, size_t second, int left, int top, int right, int bottom) {
+		pairs.push_back({first, second});
+		if (first == 0 && second == 1) {
+			ASSERT_EQ(left, 50);
+			ASSERT_EQ(top, 50);
+			ASSERT_EQ(right, 100);
+			ASSERT_EQ(bottom, 100);
+		}
+	});
+
+	// Rectangles 1 and 4 only touch
+	std::sort(pairs.begin(), pairs.end());
+	std::vector<std::pair<size_t, size_t>> expected{{0, 1}, {1, 3}};
+	ASSERT_EQ(pairs, expected);
+}
+
+} // namespace nitro